@@ -0,0 +1,381 @@
+// Ivan Makaveev, 2MI0600203
+// Benchmark - runs every Hw01 strategy over a range of N and reports time, nodes and output size
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BulkOutput.hpp"
+#include "FrogMoveGenerator.hpp"
+#include "IterativeDFS.hpp"
+#include "MoveSequence.hpp"
+#include "PackedBoard.hpp"
+#include "ParallelDFS.hpp"
+#include "RecursiveDFS.hpp"
+#include "WorkStealingPool.hpp"
+
+const char LEFT = '<';
+const char RIGHT = '>';
+const char SPACE = '_';
+
+/*
+    Settings
+*/
+struct BenchmarkSettings
+{
+    size_t fromSize = 1;
+    size_t toSize = 10;
+    size_t step = 1;
+    size_t trials = 5;
+    size_t warmup = 1;
+    size_t dfsLimit = 20;    // the DFS strategies are exponential, so they stop at this N
+    size_t threadsCount = std::thread::hardware_concurrency();
+    std::string format = "csv";
+    std::string outputPath;  // when set, traces are written in bulk to this file instead of only counted
+    std::vector<std::string> strategies = { "simple", "iterative", "parallel", "rule", "generator" };
+};
+
+struct TrialResult
+{
+    double milliseconds = 0;
+    size_t nodesCount = 0;
+    size_t outputBytes = 0;
+};
+
+struct BenchmarkRow
+{
+    std::string strategy;
+    size_t boardSize;
+    size_t trials;
+    double medianMs;
+    double p95Ms;
+    size_t nodesCount;
+    size_t outputBytes;
+};
+
+TraceWriter traceWriter;
+
+std::string fillBoard(size_t boardSize, char left, char right)
+{
+    std::string board(2 * boardSize + 1, SPACE);
+    for (size_t i = 0; i < boardSize; i++)
+    {
+        board[i] = left;
+        board[2 * boardSize - i] = right;
+    }
+
+    return board;
+}
+
+template <class Board>
+void printBoard(const Board& board)
+{
+    static std::string cells;
+    if (!traceWriter.needsText())
+    {
+        traceWriter.countLine(board.size());
+        return;
+    }
+
+    board.render(cells, LEFT, RIGHT, SPACE);
+    traceWriter.writeLine(cells.c_str(), cells.size());
+}
+
+void printCells(const std::string& board)
+{
+    traceWriter.writeLine(board.c_str(), board.size());
+}
+
+/*
+    Strategies - each returns the number of nodes it expanded (or moves it generated)
+*/
+
+// The DFS strategies search on a SmallPackedBoard whenever the 2N + 1 cells fit in it, as the solvers do
+bool fitsSmallBoard(size_t boardSize)
+{
+    return 2 * boardSize + 1 <= SmallPackedBoard::MAX_CELLS;
+}
+
+template <class Board>
+size_t searchSimple(size_t boardSize)
+{
+    std::string cells = fillBoard(boardSize, LEFT, RIGHT);
+    Board goal(std::string(cells.rbegin(), cells.rend()), LEFT, RIGHT);
+
+    RecursiveDFS<Board> search(Board(cells, LEFT, RIGHT), goal, printBoard<Board>);
+    search.search(boardSize);
+    return search.getNodesCount();
+}
+
+size_t runSimple(size_t boardSize, WorkStealingPool&)
+{
+    return fitsSmallBoard(boardSize) ? searchSimple<SmallPackedBoard>(boardSize) : searchSimple<PackedBoard>(boardSize);
+}
+
+template <class Board>
+void printSlabPath(Board board, const std::vector<size_t>& path)
+{
+    printBoard(board);
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        board.swapCells(path[i - 1], path[i]);
+        printBoard(board);
+    }
+}
+
+template <class Board>
+size_t searchIterative(size_t boardSize)
+{
+    Board board(fillBoard(boardSize, LEFT, RIGHT), LEFT, RIGHT);
+
+    IterativeDFS<Board> search(board, boardSize, (boardSize + 1) * (boardSize + 1));
+    if (search.search())
+    {
+        std::vector<size_t> path;
+        for (const auto& frame : search.getPath())
+            path.push_back(frame.slabPosition);
+        printSlabPath(board, path);
+    }
+
+    return search.getNodesCount();
+}
+
+size_t runIterative(size_t boardSize, WorkStealingPool&)
+{
+    return fitsSmallBoard(boardSize) ? searchIterative<SmallPackedBoard>(boardSize) : searchIterative<PackedBoard>(boardSize);
+}
+
+template <class Board>
+size_t searchParallel(size_t boardSize, WorkStealingPool& pool)
+{
+    Board board(fillBoard(boardSize, LEFT, RIGHT), LEFT, RIGHT);
+
+    ParallelDFS<Board> search(board, boardSize, (boardSize + 1) * (boardSize + 1));
+    if (search.search(pool))
+        printSlabPath(board, search.getPath());
+
+    return search.getNodesCount();
+}
+
+size_t runParallel(size_t boardSize, WorkStealingPool& pool)
+{
+    return fitsSmallBoard(boardSize) ? searchParallel<SmallPackedBoard>(boardSize, pool)
+        : searchParallel<PackedBoard>(boardSize, pool);
+}
+
+size_t runRule(size_t boardSize, WorkStealingPool&)
+{
+    MoveSequenceSolver solver(fillBoard(boardSize, '>', '<'), boardSize, printCells);
+    solver.findPath();
+    return solver.getMovesCount();
+}
+
+size_t runGenerator(size_t boardSize, WorkStealingPool&)
+{
+    FrogMoveGenerator generator(boardSize);
+    std::string board(generator.getBoardLength(), SPACE);
+
+    generator.fillBoard(0, &board[0]);
+    printCells(board);
+    for (uint64_t move = 0; move < generator.getMovesCount(); move++)
+    {
+        FrogMoveGenerator::applyMove(&board[0], generator.getMove(move));
+        printCells(board);
+    }
+
+    return generator.getMovesCount();
+}
+
+bool isDfsStrategy(const std::string& strategy)
+{
+    return strategy == "simple" || strategy == "iterative" || strategy == "parallel";
+}
+
+size_t (*getStrategy(const std::string& strategy))(size_t, WorkStealingPool&)
+{
+    if (strategy == "simple")
+        return runSimple;
+    if (strategy == "iterative")
+        return runIterative;
+    if (strategy == "parallel")
+        return runParallel;
+    if (strategy == "rule")
+        return runRule;
+    if (strategy == "generator")
+        return runGenerator;
+
+    return nullptr;
+}
+
+/*
+    Measurement
+*/
+
+// The trace writer is opened once for the whole run, so every trial appends to the same output
+TrialResult runTrial(size_t (*strategy)(size_t, WorkStealingPool&), size_t boardSize, WorkStealingPool& pool)
+{
+    traceWriter.resetCounts();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t nodesCount = strategy(boardSize, pool);
+    traceWriter.flush();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return { duration.count(), nodesCount, traceWriter.getBytesCount() };
+}
+
+// Nearest-rank percentile of already sorted values
+double getPercentile(const std::vector<double>& sortedValues, double percentile)
+{
+    size_t rank = (size_t)std::ceil(percentile * sortedValues.size());
+    return sortedValues[std::max<size_t>(rank, 1) - 1];
+}
+
+BenchmarkRow benchmark(const std::string& strategyName, size_t boardSize, WorkStealingPool& pool, const BenchmarkSettings& settings)
+{
+    auto strategy = getStrategy(strategyName);
+    for (size_t i = 0; i < settings.warmup; i++)
+        runTrial(strategy, boardSize, pool);
+
+    std::vector<double> times;
+    TrialResult last;
+    for (size_t i = 0; i < settings.trials; i++)
+    {
+        last = runTrial(strategy, boardSize, pool);
+        times.push_back(last.milliseconds);
+    }
+    std::sort(times.begin(), times.end());
+
+    double median = (times.size() & 1) ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+    return { strategyName, boardSize, settings.trials, median, getPercentile(times, 0.95), last.nodesCount, last.outputBytes };
+}
+
+/*
+    Reporting
+*/
+
+void printCsv(const std::vector<BenchmarkRow>& rows)
+{
+    std::cout << "strategy,n,trials,median_ms,p95_ms,nodes,output_bytes" << std::endl;
+    for (const auto& row : rows)
+    {
+        std::cout << row.strategy << ',' << row.boardSize << ',' << row.trials << ','
+            << row.medianMs << ',' << row.p95Ms << ',' << row.nodesCount << ',' << row.outputBytes << std::endl;
+    }
+}
+
+void printJson(const std::vector<BenchmarkRow>& rows)
+{
+    std::cout << '[' << std::endl;
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        const auto& row = rows[i];
+        std::cout << "  {\"strategy\": \"" << row.strategy << "\", \"n\": " << row.boardSize
+            << ", \"trials\": " << row.trials << ", \"median_ms\": " << row.medianMs << ", \"p95_ms\": " << row.p95Ms
+            << ", \"nodes\": " << row.nodesCount << ", \"output_bytes\": " << row.outputBytes << '}'
+            << (i + 1 < rows.size() ? "," : "") << std::endl;
+    }
+    std::cout << ']' << std::endl;
+}
+
+std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> result;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+            result.push_back(item);
+    }
+
+    return result;
+}
+
+/*
+    Command line:
+        --from <N> --to <N> --step <S>     sizes to sweep (default 1..10)
+        --trials <T> --warmup <W>          measured and discarded runs per size (default 5 and 1)
+        --strategies <a,b,...>             any of simple, iterative, parallel, rule, generator (default all)
+        --dfs-limit <N>                    largest N for the DFS strategies (default 20)
+        --threads <T>                      threads for the parallel strategy
+        --format <csv|json>                report format (default csv)
+        --output <file>                    write the traces of all trials in bulk to one file instead of only counting them
+*/
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string value = argv[++i];
+        if (arg == "--from")
+            settings.fromSize = std::stoul(value);
+        else if (arg == "--to")
+            settings.toSize = std::stoul(value);
+        else if (arg == "--step")
+            settings.step = std::max<size_t>(1, std::stoul(value));
+        else if (arg == "--trials")
+            settings.trials = std::max<size_t>(1, std::stoul(value));
+        else if (arg == "--warmup")
+            settings.warmup = std::stoul(value);
+        else if (arg == "--strategies")
+            settings.strategies = splitList(value);
+        else if (arg == "--dfs-limit")
+            settings.dfsLimit = std::stoul(value);
+        else if (arg == "--threads")
+            settings.threadsCount = std::stoul(value);
+        else if (arg == "--format")
+            settings.format = value;
+        else if (arg == "--output")
+            settings.outputPath = value;
+        else
+            i--;
+    }
+
+    for (const auto& strategy : settings.strategies)
+    {
+        if (!getStrategy(strategy))
+        {
+            std::cerr << "Unknown strategy " << strategy << std::endl;
+            return 1;
+        }
+    }
+
+    if (settings.format != "csv" && settings.format != "json")
+    {
+        std::cerr << "Unknown format " << settings.format << std::endl;
+        return 1;
+    }
+
+    if (!traceWriter.open(settings.outputPath.empty() ? OutputMode::CountOnly : OutputMode::Bulk, settings.outputPath))
+    {
+        std::cerr << "Cannot open " << settings.outputPath << std::endl;
+        return 1;
+    }
+
+    WorkStealingPool pool(settings.threadsCount);
+    std::vector<BenchmarkRow> rows;
+    for (size_t boardSize = settings.fromSize; boardSize <= settings.toSize; boardSize += settings.step)
+    {
+        for (const auto& strategy : settings.strategies)
+        {
+            if (isDfsStrategy(strategy) && boardSize > settings.dfsLimit)
+                continue;
+
+            rows.push_back(benchmark(strategy, boardSize, pool, settings));
+        }
+    }
+
+    traceWriter.close();
+
+    if (settings.format == "json")
+        printJson(rows);
+    else
+        printCsv(rows);
+}
@@ -0,0 +1,276 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/*
+    Output modes for the move trace:
+    Stream    - every board is written with std::endl (original behaviour)
+    Bulk      - boards are collected in a reusable buffer and written with a few large writes
+    CountOnly - nothing is written, only the emitted states are counted
+*/
+enum class OutputMode
+{
+    Stream,
+    Bulk,
+    CountOnly
+};
+
+const size_t DEFAULT_BUFFER_CAPACITY = 1 << 22;
+
+class TraceWriter
+{
+    OutputMode mode = OutputMode::Stream;
+    std::FILE* file = stdout;
+    bool ownsFile = false;
+
+    std::vector<char> buffer;
+    size_t bufferUsed = 0;
+
+    size_t linesCount = 0;
+    size_t bytesCount = 0;
+
+    void writeBlock(const char* data, size_t length)
+    {
+        std::fwrite(data, 1, length, file);
+    }
+
+public:
+    TraceWriter() = default;
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    ~TraceWriter()
+    {
+        close();
+    }
+
+    bool open(OutputMode outputMode, const std::string& outputPath = "", size_t capacity = DEFAULT_BUFFER_CAPACITY)
+    {
+        close();
+        mode = outputMode;
+        linesCount = 0;
+        bytesCount = 0;
+
+        if (mode != OutputMode::Bulk)
+        {
+            return true;
+        }
+
+        if (!outputPath.empty())
+        {
+            file = std::fopen(outputPath.c_str(), "wb");
+            if (!file)
+            {
+                file = stdout;
+                return false;
+            }
+            ownsFile = true;
+        }
+
+        // The buffer is kept between runs, so it is only grown and never shrunk
+        if (buffer.size() < capacity)
+        {
+            buffer.resize(capacity);
+        }
+        bufferUsed = 0;
+
+        // Anything already sent through std::cout must land before our raw writes
+        std::cout.flush();
+        return true;
+    }
+
+    void writeLine(const char* line, size_t length)
+    {
+        linesCount++;
+        bytesCount += length + 1;
+
+        if (mode == OutputMode::CountOnly)
+        {
+            return;
+        }
+
+        if (mode == OutputMode::Stream)
+        {
+            std::cout << line << std::endl;
+            return;
+        }
+
+        if (bufferUsed + length + 1 > buffer.size())
+        {
+            flush();
+
+            if (length + 1 > buffer.size())
+            {
+                writeBlock(line, length);
+                writeBlock("\n", 1);
+                return;
+            }
+        }
+
+        std::memcpy(buffer.data() + bufferUsed, line, length);
+        bufferUsed += length;
+        buffer[bufferUsed++] = '\n';
+    }
+
+    void writeLine(const char* line)
+    {
+        writeLine(line, std::strlen(line));
+    }
+
+    // Counts a line without rendering it, for solvers that skip building the text in CountOnly mode
+    void countLine(size_t length)
+    {
+        linesCount++;
+        bytesCount += length + 1;
+    }
+
+    // Counts `lines` lines of `length` characters each without rendering them
+    void countLines(size_t lines, size_t length)
+    {
+        linesCount += lines;
+        bytesCount += lines * (length + 1);
+    }
+
+    // Counts from zero again while the output stays open, for several runs written to one file
+    void resetCounts()
+    {
+        linesCount = 0;
+        bytesCount = 0;
+    }
+
+    bool needsText() const
+    {
+        return mode != OutputMode::CountOnly;
+    }
+
+    // Writes an already rendered block of `lines` newline-terminated lines
+    void writeLines(const char* data, size_t length, size_t lines)
+    {
+        linesCount += lines;
+        bytesCount += length;
+
+        if (mode == OutputMode::CountOnly)
+        {
+            return;
+        }
+
+        if (mode == OutputMode::Stream)
+        {
+            std::cout.write(data, length);
+            std::cout.flush();
+            return;
+        }
+
+        if (bufferUsed + length > buffer.size())
+        {
+            flush();
+
+            if (length > buffer.size())
+            {
+                writeBlock(data, length);
+                return;
+            }
+        }
+
+        std::memcpy(buffer.data() + bufferUsed, data, length);
+        bufferUsed += length;
+    }
+
+    void flush()
+    {
+        if (mode != OutputMode::Bulk)
+        {
+            return;
+        }
+
+        if (bufferUsed > 0)
+        {
+            writeBlock(buffer.data(), bufferUsed);
+            bufferUsed = 0;
+        }
+        std::fflush(file);
+    }
+
+    void close()
+    {
+        flush();
+
+        if (ownsFile)
+        {
+            std::fclose(file);
+            ownsFile = false;
+        }
+        file = stdout;
+    }
+
+    OutputMode getMode() const
+    {
+        return mode;
+    }
+
+    size_t getLinesCount() const
+    {
+        return linesCount;
+    }
+
+    size_t getBytesCount() const
+    {
+        return bytesCount;
+    }
+};
+
+/*
+    Command line: [--bulk | --count-only] [--output <file>]
+    With no arguments the solvers keep printing to the console line by line.
+    `solverFlags` are the solver's own flags, each followed by a value; any other argument is reported
+    and false is returned.
+*/
+inline bool parseOutputMode(int argc, char** argv, OutputMode& mode, std::string& outputPath,
+    std::initializer_list<const char*> solverFlags = {})
+{
+    mode = OutputMode::Stream;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool isSolverFlag = std::find(solverFlags.begin(), solverFlags.end(), arg) != solverFlags.end();
+        if (arg == "--bulk")
+        {
+            mode = OutputMode::Bulk;
+        }
+        else if (arg == "--count-only")
+        {
+            mode = OutputMode::CountOnly;
+        }
+        else if (arg != "--output" && !isSolverFlag)
+        {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return false;
+        }
+        else if (i + 1 >= argc)
+        {
+            std::cerr << arg << " needs a value" << std::endl;
+            return false;
+        }
+        else if (arg == "--output")
+        {
+            outputPath = argv[++i];
+            if (mode == OutputMode::Stream)
+            {
+                mode = OutputMode::Bulk;
+            }
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return true;
+}
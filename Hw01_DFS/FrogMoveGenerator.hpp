@@ -0,0 +1,157 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+/*
+    Closed form of the rule-based move sequence from Solution 3.
+
+    For N frogs per side the solution has N * (N + 2) moves split into three parts:
+    - phases i = 1..N: (i - 1) big jumps and one small step, alternating left/right
+    - middle: N big jumps
+    - phases i = N..1: one small step and (i - 1) big jumps - the first part mirrored and reversed
+
+    After phase i of the first part the slab is at N + (-1)^i * i and the cells
+    [N - i, N + i] hold alternating frogs, so any move or board can be derived
+    directly from its index without simulating the moves before it.
+*/
+
+struct FrogMove
+{
+    // The slab moves from slabPosition to slabPosition + offset (offset is -2, -1, 1 or 2)
+    uint64_t slabPosition;
+    int offset;
+};
+
+class FrogMoveGenerator
+{
+    uint64_t boardSize;
+    uint64_t halfMoves;
+
+    static uint64_t getTriangular(uint64_t n)
+    {
+        return n * (n + 1) / 2;
+    }
+
+    // Largest i with getTriangular(i) <= index
+    static uint64_t getPhaseBefore(uint64_t index)
+    {
+        uint64_t phase = (uint64_t)((std::sqrt(8.0 * (double)index + 1.0) - 1.0) / 2.0);
+        while (getTriangular(phase) > index)
+            phase--;
+        while (getTriangular(phase + 1) <= index)
+            phase++;
+
+        return phase;
+    }
+
+    uint64_t getPhaseEnd(uint64_t phase) const
+    {
+        return (phase & 1) ? boardSize - phase : boardSize + phase;
+    }
+
+    // The first part (phases 1..N) and the middle jumps
+    FrogMove getForwardMove(uint64_t index) const
+    {
+        if (index >= halfMoves)
+        {
+            uint64_t step = index - halfMoves;
+            if (boardSize & 1)
+                return { 2 * step, 2 };
+
+            return { 2 * boardSize - 2 * step, -2 };
+        }
+
+        uint64_t phase = getPhaseBefore(index) + 1;
+        uint64_t step = index - getTriangular(phase - 1);
+        int direction = (phase & 1) ? -1 : 1;
+        uint64_t start = getPhaseEnd(phase - 1);
+
+        uint64_t slabPosition = start + direction * (int64_t)(2 * step);
+        int offset = (step + 1 < phase) ? 2 * direction : direction;
+        return { slabPosition, offset };
+    }
+
+    void fillForwardBoard(uint64_t state, char* board) const
+    {
+        uint64_t phase = (state >= halfMoves) ? boardSize : getPhaseBefore(state);
+        uint64_t jumps = state - getTriangular(phase);
+        uint64_t slabPosition = getPhaseEnd(phase);
+        int direction = ((phase + 1) & 1) ? -1 : 1;
+
+        for (uint64_t i = 0; i < boardSize - phase; i++)
+        {
+            board[i] = LEFT;
+            board[2 * boardSize - i] = RIGHT;
+        }
+
+        uint64_t first = boardSize - phase;
+        uint64_t frogsStart = (phase & 1) ? first + 1 : first;
+        for (uint64_t i = 0; i < 2 * phase; i++)
+        {
+            board[frogsStart + i] = (i & 1) ? RIGHT : LEFT;
+        }
+        board[slabPosition] = SPACE;
+
+        for (uint64_t i = 0; i < jumps; i++)
+        {
+            uint64_t next = slabPosition + direction * 2;
+            board[slabPosition] = board[next];
+            board[next] = SPACE;
+            slabPosition = next;
+        }
+    }
+
+public:
+    static const char LEFT = '>';
+    static const char RIGHT = '<';
+    static const char SPACE = '_';
+
+    FrogMoveGenerator(uint64_t boardSize)
+        : boardSize(boardSize), halfMoves(getTriangular(boardSize))
+    { }
+
+    uint64_t getMovesCount() const
+    {
+        return boardSize * (boardSize + 2);
+    }
+
+    uint64_t getBoardLength() const
+    {
+        return 2 * boardSize + 1;
+    }
+
+    // The k-th move (0-based) in O(1)
+    FrogMove getMove(uint64_t index) const
+    {
+        uint64_t movesCount = getMovesCount();
+        if (index < halfMoves + boardSize)
+            return getForwardMove(index);
+
+        // The second part mirrors the first one: p[k] = 2N - p[T - k]
+        FrogMove mirrored = getForwardMove(movesCount - 1 - index);
+        return { 2 * boardSize - (mirrored.slabPosition + mirrored.offset), mirrored.offset };
+    }
+
+    // The board after the first `state` moves in O(N); board must hold getBoardLength() chars
+    void fillBoard(uint64_t state, char* board) const
+    {
+        uint64_t movesCount = getMovesCount();
+        if (2 * state <= movesCount)
+        {
+            fillForwardBoard(state, board);
+            return;
+        }
+
+        // The second half of the trace is the first half read backwards with the board reversed
+        fillForwardBoard(movesCount - state, board);
+        std::reverse(board, board + getBoardLength());
+    }
+
+    static void applyMove(char* board, const FrogMove& move)
+    {
+        std::swap(board[move.slabPosition], board[move.slabPosition + move.offset]);
+    }
+};
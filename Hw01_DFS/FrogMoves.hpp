@@ -0,0 +1,14 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+
+/*
+    Moves into the slab, as returned by PackedBoard::getMoves
+*/
+enum FrogMoves : unsigned
+{
+    JUMP_FROM_LEFT = 1,     // left frog at slab - 2 jumps over the right frog at slab - 1
+    JUMP_FROM_RIGHT = 2,    // right frog at slab + 2 jumps over the left frog at slab + 1
+    STEP_FROM_LEFT = 4,     // left frog at slab - 1
+    STEP_FROM_RIGHT = 8     // right frog at slab + 1
+};
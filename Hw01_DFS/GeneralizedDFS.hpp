@@ -0,0 +1,172 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "PackedBoard.hpp"
+
+/*
+    DFS for arbitrary start and goal boards - any number of frogs on each side and any number of gaps.
+    A frog steps into an adjacent gap in its direction or jumps over one frog of the other kind into a gap.
+    Frogs never move back, so the states form a DAG: a board that was already expanded either lies on the
+    current path or has no way to the goal, and the transposition table of visited boards skips it.
+    Boards with a frozen ">><<" block are cut as well, unless the goal itself contains one.
+*/
+class GeneralizedDFS
+{
+    static const unsigned MOVES_COUNT = 4;
+
+    struct Frame
+    {
+        size_t gapIndex;        // gap whose moves are being tried
+        unsigned untriedMoves;  // FrogMoves mask for that gap
+        size_t gapFrom;         // the move that led to this state took the gap from gapFrom to gapTo
+        size_t gapTo;
+    };
+
+    PackedBoard board;
+    PackedBoard goal;
+    std::vector<size_t> gaps;
+
+    std::vector<Frame> stack;
+    std::unordered_set<PackedBoard, PackedBoardHash> visited;
+    size_t visitedLimit;
+    bool pruneDeadlocks;
+
+    size_t nodesCount = 0;
+    size_t transpositionsCount = 0;
+    size_t deadlocksCount = 0;
+
+    static int getMoveOffset(unsigned moveIndex)
+    {
+        static const int OFFSETS[MOVES_COUNT] = { -2, 2, -1, 1 };
+        return OFFSETS[moveIndex];
+    }
+
+    static unsigned getFirstMove(unsigned moves)
+    {
+        static const unsigned char FIRST_MOVE[1 << MOVES_COUNT] = { 4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0 };
+        return FIRST_MOVE[moves];
+    }
+
+    Frame createFrame(size_t gapFrom, size_t gapTo) const
+    {
+        return { 0, gaps.empty() ? 0 : board.getMoves(gaps[0]), gapFrom, gapTo };
+    }
+
+    // Moves the frog at `from` into the gap `gapIndex`; the gap takes the frog's old cell
+    void moveGap(size_t gapIndex, size_t from)
+    {
+        board.swapCells(from, gaps[gapIndex]);
+        gaps[gapIndex] = from;
+    }
+
+    bool markVisited()
+    {
+        if (visited.size() >= visitedLimit)
+            return visited.count(board) == 0;
+
+        return visited.insert(board).second;
+    }
+
+public:
+    // visitedLimit caps the transposition table; once full it is only used for lookups
+    GeneralizedDFS(const PackedBoard& start, const PackedBoard& goal, size_t visitedLimit = SIZE_MAX)
+        : board(start), goal(goal), visitedLimit(visitedLimit), pruneDeadlocks(!goal.hasDeadlock())
+    {
+        for (size_t i = 0; i < start.size(); i++)
+        {
+            if (start.isEmpty(i))
+                gaps.push_back(i);
+        }
+    }
+
+    bool search()
+    {
+        stack.clear();
+        visited.clear();
+        nodesCount = 1;
+        transpositionsCount = 0;
+        deadlocksCount = 0;
+
+        stack.push_back(createFrame(0, 0));
+        markVisited();
+
+        while (!stack.empty())
+        {
+            if (board == goal)
+                return true;
+
+            Frame& frame = stack.back();
+            while (frame.untriedMoves == 0 && ++frame.gapIndex < gaps.size())
+                frame.untriedMoves = board.getMoves(gaps[frame.gapIndex]);
+
+            if (frame.gapIndex >= gaps.size())
+            {
+                // All moves are exhausted - undo the move that led here
+                if (stack.size() > 1)
+                {
+                    size_t gapIndex = stack[stack.size() - 2].gapIndex;
+                    moveGap(gapIndex, frame.gapFrom);
+                }
+                stack.pop_back();
+                continue;
+            }
+
+            unsigned moveIndex = getFirstMove(frame.untriedMoves);
+            frame.untriedMoves &= frame.untriedMoves - 1;
+
+            size_t gapPosition = gaps[frame.gapIndex];
+            size_t nextGapPosition = gapPosition + getMoveOffset(moveIndex);
+            moveGap(frame.gapIndex, nextGapPosition);
+
+            if (pruneDeadlocks && (board.hasDeadlockNear(gapPosition) || board.hasDeadlockNear(nextGapPosition)))
+            {
+                deadlocksCount++;
+                moveGap(frame.gapIndex, gapPosition);
+                continue;
+            }
+
+            if (!markVisited())
+            {
+                transpositionsCount++;
+                moveGap(frame.gapIndex, gapPosition);
+                continue;
+            }
+
+            nodesCount++;
+            stack.push_back(createFrame(gapPosition, nextGapPosition));
+        }
+
+        return false;
+    }
+
+    // Replays the found path from `start`, calling `visit` with every board from the start to the goal
+    template <class Visitor>
+    void forEachState(PackedBoard start, Visitor visit) const
+    {
+        visit(start);
+        for (size_t i = 1; i < stack.size(); i++)
+        {
+            start.swapCells(stack[i].gapFrom, stack[i].gapTo);
+            visit(start);
+        }
+    }
+
+    size_t getNodesCount() const
+    {
+        return nodesCount;
+    }
+
+    size_t getTranspositionsCount() const
+    {
+        return transpositionsCount;
+    }
+
+    size_t getDeadlocksCount() const
+    {
+        return deadlocksCount;
+    }
+};
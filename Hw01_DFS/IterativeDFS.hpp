@@ -0,0 +1,141 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "PackedBoard.hpp"
+
+struct SearchFrame
+{
+    size_t slabPosition;
+    unsigned nextMoveIndex;  // the first move not tried yet, in the order of the recursive solvers
+};
+
+/*
+    Depth-first search over the slab moves with an explicit, preallocated stack instead of recursion,
+    so the depth is only limited by memory. Moves are tried in the same order as the recursive solvers.
+    The frames on the stack are the path itself - when the goal depth is reached they hold the slab
+    position of every state from the start to the goal.
+    Board is PackedBoard or, when the board fits, SmallPackedBoard - the search works on a local copy,
+    so a small board stays in registers for the whole search.
+*/
+template <class Board>
+class IterativeDFS
+{
+    static const size_t CANCEL_CHECK_INTERVAL = 1 << 12;
+
+    Board startBoard;
+    size_t startSlabPosition;
+    size_t goalDepth;
+
+    std::vector<SearchFrame> stack;
+    size_t nodesCount = 1;
+
+public:
+    // goalDepth is the number of states on a full path, the start state included
+    IterativeDFS(const Board& board, size_t slabPosition, size_t goalDepth)
+        : startBoard(board), startSlabPosition(slabPosition), goalDepth(goalDepth), stack(goalDepth)
+    { }
+
+    // Stops early (returning false) once `cancelled` is set by another thread
+    bool search(const std::atomic<bool>* cancelled = nullptr)
+    {
+        if (goalDepth == 0)
+        {
+            return false;
+        }
+
+        // The current frame lives in locals and is only written to the stack when the search goes deeper,
+        // so the next node never waits on a frame it has just stored
+        Board board = startBoard;
+        SearchFrame* frames = stack.data();
+        size_t lastDepth = goalDepth - 1;
+        size_t depth = 0;
+        size_t slabPosition = startSlabPosition;
+        unsigned nextMoveIndex = 0;
+        size_t nodes = 1;
+
+        while (depth != lastDepth)
+        {
+            size_t nextSlabPosition;
+
+            // Resumes where the frame left off and checks only the moves it gets to, as the recursion does
+            switch (nextMoveIndex)
+            {
+            case 0:
+                if (board.canMove(slabPosition, JUMP_FROM_LEFT))
+                {
+                    nextSlabPosition = slabPosition - 2;
+                    nextMoveIndex = 1;
+                    break;
+                }
+                [[fallthrough]];
+            case 1:
+                if (board.canMove(slabPosition, JUMP_FROM_RIGHT))
+                {
+                    nextSlabPosition = slabPosition + 2;
+                    nextMoveIndex = 2;
+                    break;
+                }
+                [[fallthrough]];
+            case 2:
+                if (board.canMove(slabPosition, STEP_FROM_LEFT))
+                {
+                    nextSlabPosition = slabPosition - 1;
+                    nextMoveIndex = 3;
+                    break;
+                }
+                [[fallthrough]];
+            case 3:
+                if (board.canMove(slabPosition, STEP_FROM_RIGHT))
+                {
+                    nextSlabPosition = slabPosition + 1;
+                    nextMoveIndex = 4;
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                // All moves are exhausted - return to the parent and restore its board
+                if (depth == 0)
+                {
+                    nodesCount = nodes;
+                    return false;
+                }
+
+                depth--;
+                board.swapCells(slabPosition, frames[depth].slabPosition);
+                slabPosition = frames[depth].slabPosition;
+                nextMoveIndex = frames[depth].nextMoveIndex;
+                continue;
+            }
+
+            frames[depth++] = { slabPosition, nextMoveIndex };
+            board.swapCells(nextSlabPosition, slabPosition);
+            slabPosition = nextSlabPosition;
+            nextMoveIndex = 0;
+
+            nodes++;
+            if (cancelled && nodes % CANCEL_CHECK_INTERVAL == 0 && cancelled->load(std::memory_order_relaxed))
+            {
+                nodesCount = nodes;
+                return false;
+            }
+        }
+
+        frames[depth] = { slabPosition, nextMoveIndex };
+        nodesCount = nodes;
+        return true;
+    }
+
+    // The slab position of every state on the found path, from the start to the goal
+    const std::vector<SearchFrame>& getPath() const
+    {
+        return stack;
+    }
+
+    size_t getNodesCount() const
+    {
+        return nodesCount;
+    }
+};
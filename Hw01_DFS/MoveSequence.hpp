@@ -0,0 +1,147 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <functional>
+#include <string>
+#include <utility>
+
+/*
+    The rule-based solver of Solution 3: the moves follow a fixed pattern, so only the exact
+    N * (N + 2) moves are simulated and every board is printed right after its move.
+*/
+class MoveSequenceSolver
+{
+    std::string board;
+    size_t boardSize;
+    size_t slabPosition = 0;
+    std::function<void(const std::string&)> print;
+
+    void smallLeftStep()
+    {
+        std::swap(board[slabPosition - 1], board[slabPosition]);
+        print(board);
+        slabPosition -= 1;
+    }
+
+    void smallRightStep()
+    {
+        std::swap(board[slabPosition + 1], board[slabPosition]);
+        print(board);
+        slabPosition += 1;
+    }
+
+    void bigLeftStep()
+    {
+        std::swap(board[slabPosition - 2], board[slabPosition]);
+        print(board);
+        slabPosition -= 2;
+    }
+
+    void bigRightStep()
+    {
+        std::swap(board[slabPosition + 2], board[slabPosition]);
+        print(board);
+        slabPosition += 2;
+    }
+
+    void performRightStep(size_t moveCount, bool reverse)
+    {
+        if (reverse)
+        {
+            smallRightStep();
+        }
+
+        for (size_t i = 1; i < moveCount; i++)
+        {
+            bigRightStep();
+        }
+
+        if (!reverse)
+        {
+            smallRightStep();
+        }
+    }
+
+    void performLeftStep(size_t moveCount, bool reverse)
+    {
+        if (reverse)
+        {
+            smallLeftStep();
+        }
+
+        for (size_t i = 1; i < moveCount; i++)
+        {
+            bigLeftStep();
+        }
+
+        if (!reverse)
+        {
+            smallLeftStep();
+        }
+    }
+
+    void performMiddleStep(size_t moveCount, bool isLeft)
+    {
+        if (isLeft)
+        {
+            for (size_t i = 0; i < moveCount; i++)
+            {
+                bigLeftStep();
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < moveCount; i++)
+            {
+                bigRightStep();
+            }
+        }
+    }
+
+public:
+    // board is the start board with boardSize frogs on each side
+    MoveSequenceSolver(const std::string& board, size_t boardSize, std::function<void(const std::string&)> print)
+        : board(board), boardSize(boardSize), print(print)
+    { }
+
+    void findPath()
+    {
+        print(board);
+
+        bool isNextMoveLeft = true;
+        slabPosition = boardSize;
+        for (size_t i = 1; i <= boardSize; i++)
+        {
+            if (isNextMoveLeft)
+            {
+                performLeftStep(i, false);
+            }
+            else
+            {
+                performRightStep(i, false);
+            }
+            isNextMoveLeft = !isNextMoveLeft;
+        }
+
+        performMiddleStep(boardSize, isNextMoveLeft);
+        isNextMoveLeft = !isNextMoveLeft;
+
+        for (size_t i = boardSize; i >= 1; i--)
+        {
+            if (isNextMoveLeft)
+            {
+                performLeftStep(i, true);
+            }
+            else
+            {
+                performRightStep(i, true);
+            }
+            isNextMoveLeft = !isNextMoveLeft;
+        }
+    }
+
+    size_t getMovesCount() const
+    {
+        return boardSize * (boardSize + 2);
+    }
+};
@@ -0,0 +1,338 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FrogMoves.hpp"
+
+/*
+    Board stored as two bitboards in 64-bit words: one with a bit for every frog that starts on the left
+    (and moves right), one for every frog that starts on the right; a cell in neither is empty.
+    The words of both bitboards are interleaved, so the two bits of a cell share a cache line and a board
+    of up to 55 cells is a single pair of words - a move toggles two bits of one word and the goal test
+    compares two words. Every cell is shifted by PADDING cells so that the neighbourhood of any cell
+    can be read without bounds checks - the padding cells are always empty.
+*/
+class PackedBoard
+{
+    static const size_t PADDING = 4;
+    static const size_t WORD_BITS = 64;
+    static const size_t LEFT_FROGS = 0;
+    static const size_t RIGHT_FROGS = 1;
+    static const size_t BITBOARDS_COUNT = 2;
+
+    size_t cellsCount = 0;
+    std::vector<uint64_t> words;
+
+    uint64_t getBit(size_t bitboard, size_t index) const
+    {
+        return (words[index / WORD_BITS * BITBOARDS_COUNT + bitboard] >> (index % WORD_BITS)) & 1;
+    }
+
+    void toggleBit(size_t bitboard, size_t index)
+    {
+        words[index / WORD_BITS * BITBOARDS_COUNT + bitboard] ^= uint64_t(1) << (index % WORD_BITS);
+    }
+
+    // `count` (at most 16) bits starting at `index`; only windows crossing a word boundary read two words
+    uint64_t getWindow(size_t bitboard, size_t index, size_t count) const
+    {
+        size_t word = index / WORD_BITS * BITBOARDS_COUNT + bitboard;
+        size_t shift = index % WORD_BITS;
+
+        uint64_t window = words[word] >> shift;
+        if (shift + count > WORD_BITS)
+            window |= words[word + BITBOARDS_COUNT] << (WORD_BITS - shift);
+
+        return window & ((uint64_t(1) << count) - 1);
+    }
+
+    // Bit i is set when a ">><<" block starts at cell i of the windows - none of its four frogs can ever move again
+    static uint64_t getDeadlocks(uint64_t leftFrogs, uint64_t rightFrogs)
+    {
+        return leftFrogs & (leftFrogs >> 1) & (rightFrogs >> 2) & (rightFrogs >> 3);
+    }
+
+public:
+    PackedBoard() = default;
+
+    PackedBoard(const std::string& cells, char left, char right)
+        : cellsCount(cells.size()), words(((cells.size() + 2 * PADDING) / WORD_BITS + 1) * BITBOARDS_COUNT, 0)
+    {
+        for (size_t i = 0; i < cellsCount; i++)
+        {
+            if (cells[i] == left)
+                toggleBit(LEFT_FROGS, i + PADDING);
+            else if (cells[i] == right)
+                toggleBit(RIGHT_FROGS, i + PADDING);
+        }
+    }
+
+    size_t size() const
+    {
+        return cellsCount;
+    }
+
+    bool isLeftFrog(size_t cell) const
+    {
+        return getBit(LEFT_FROGS, cell + PADDING);
+    }
+
+    bool isRightFrog(size_t cell) const
+    {
+        return getBit(RIGHT_FROGS, cell + PADDING);
+    }
+
+    bool isEmpty(size_t cell) const
+    {
+        return !isLeftFrog(cell) && !isRightFrog(cell);
+    }
+
+    // Whether a single move into the empty cell `slab` is possible; searches that try the moves one at a time
+    // read only the bits of the moves they get to
+    bool canMove(size_t slab, FrogMoves move) const
+    {
+        slab += PADDING;
+        switch (move)
+        {
+        case JUMP_FROM_LEFT:
+            return getBit(LEFT_FROGS, slab - 2) & getBit(RIGHT_FROGS, slab - 1);
+        case JUMP_FROM_RIGHT:
+            return getBit(RIGHT_FROGS, slab + 2) & getBit(LEFT_FROGS, slab + 1);
+        case STEP_FROM_LEFT:
+            return getBit(LEFT_FROGS, slab - 1);
+        default:
+            return getBit(RIGHT_FROGS, slab + 1);
+        }
+    }
+
+    // All moves into the empty cell `slab`, read from the 5-bit windows of cells [slab - 2, slab + 2]
+    unsigned getMoves(size_t slab) const
+    {
+        unsigned leftFrogs = (unsigned)getWindow(LEFT_FROGS, slab + PADDING - 2, 5);
+        unsigned rightFrogs = (unsigned)getWindow(RIGHT_FROGS, slab + PADDING - 2, 5);
+
+        unsigned moves = 0;
+        if ((leftFrogs & 0b00001) && (rightFrogs & 0b00010))
+            moves |= JUMP_FROM_LEFT;
+        if ((rightFrogs & 0b10000) && (leftFrogs & 0b01000))
+            moves |= JUMP_FROM_RIGHT;
+        if (leftFrogs & 0b00010)
+            moves |= STEP_FROM_LEFT;
+        if (rightFrogs & 0b01000)
+            moves |= STEP_FROM_RIGHT;
+
+        return moves;
+    }
+
+    // Whether a ">><<" block overlaps `cell` - after a move only the two changed cells need checking
+    bool hasDeadlockNear(size_t cell) const
+    {
+        size_t first = cell + PADDING - 3;
+        return getDeadlocks(getWindow(LEFT_FROGS, first, 7), getWindow(RIGHT_FROGS, first, 7)) & 0xF;
+    }
+
+    bool hasDeadlock() const
+    {
+        for (size_t i = 0; i + 3 < cellsCount; i++)
+        {
+            if (getDeadlocks(getWindow(LEFT_FROGS, i + PADDING, 4), getWindow(RIGHT_FROGS, i + PADDING, 4)) & 1)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Swaps two cells, one of which is empty: toggles both bits in the bitboard of the frog, picked without branching
+    void swapCells(size_t first, size_t second)
+    {
+        first += PADDING;
+        second += PADDING;
+
+        size_t bitboard = RIGHT_FROGS - (getBit(LEFT_FROGS, first) | getBit(LEFT_FROGS, second));
+        toggleBit(bitboard, first);
+        toggleBit(bitboard, second);
+    }
+
+    // Compared word by word from the left, since boards in a search usually differ on the first cells already
+    bool operator==(const PackedBoard& other) const
+    {
+        if (cellsCount != other.cellsCount)
+            return false;
+
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            if (words[i] != other.words[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const PackedBoard& other) const
+    {
+        return !(*this == other);
+    }
+
+    size_t hash() const
+    {
+        uint64_t result = cellsCount;
+        for (uint64_t word : words)
+        {
+            result ^= word + 0x9e3779b97f4a7c15ULL + (result << 6) + (result >> 2);
+        }
+
+        return (size_t)result;
+    }
+
+    // The char representation is only built when a board has to be printed
+    void render(std::string& cells, char left, char right, char space) const
+    {
+        cells.resize(cellsCount);
+        for (size_t i = 0; i < cellsCount; i++)
+        {
+            if (isLeftFrog(i))
+                cells[i] = left;
+            else if (isRightFrog(i))
+                cells[i] = right;
+            else
+                cells[i] = space;
+        }
+    }
+};
+
+/*
+    The same two bitboards for a board of up to MAX_CELLS cells, held in one pair of plain words.
+    The end of the board is marked by a left frog bit on the last padding cell, which no move ever reads,
+    so the whole board is 16 bytes: kept in a local or passed by value it stays in registers, a move is
+    two XORs and the goal test two compares with nothing going through memory - the slab searches use it
+    whenever the board fits.
+*/
+class SmallPackedBoard
+{
+    static const size_t PADDING = 2;
+
+    uint64_t leftFrogs = uint64_t(1) << (PADDING + 1);
+    uint64_t rightFrogs = 0;
+
+    static uint64_t getBit(uint64_t bitboard, size_t index)
+    {
+        return (bitboard >> index) & 1;
+    }
+
+public:
+    static const size_t MAX_CELLS = 64 - 2 * PADDING;
+
+    SmallPackedBoard() = default;
+
+    SmallPackedBoard(const std::string& cells, char left, char right)
+        : leftFrogs(uint64_t(1) << (cells.size() + PADDING + 1))
+    {
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            if (cells[i] == left)
+                leftFrogs |= uint64_t(1) << (i + PADDING);
+            else if (cells[i] == right)
+                rightFrogs |= uint64_t(1) << (i + PADDING);
+        }
+    }
+
+    // Only needed when a board is printed, so the end marker is simply searched for
+    size_t size() const
+    {
+        size_t end = 63;
+        while (!getBit(leftFrogs, end))
+            end--;
+
+        return end - PADDING - 1;
+    }
+
+    bool isLeftFrog(size_t cell) const
+    {
+        return getBit(leftFrogs, cell + PADDING);
+    }
+
+    bool isRightFrog(size_t cell) const
+    {
+        return getBit(rightFrogs, cell + PADDING);
+    }
+
+    bool isEmpty(size_t cell) const
+    {
+        return !isLeftFrog(cell) && !isRightFrog(cell);
+    }
+
+    bool canMove(size_t slab, FrogMoves move) const
+    {
+        slab += PADDING;
+        switch (move)
+        {
+        case JUMP_FROM_LEFT:
+            return getBit(leftFrogs, slab - 2) & getBit(rightFrogs, slab - 1);
+        case JUMP_FROM_RIGHT:
+            return getBit(rightFrogs, slab + 2) & getBit(leftFrogs, slab + 1);
+        case STEP_FROM_LEFT:
+            return getBit(leftFrogs, slab - 1);
+        default:
+            return getBit(rightFrogs, slab + 1);
+        }
+    }
+
+    unsigned getMoves(size_t slab) const
+    {
+        unsigned moves = 0;
+        if (canMove(slab, JUMP_FROM_LEFT))
+            moves |= JUMP_FROM_LEFT;
+        if (canMove(slab, JUMP_FROM_RIGHT))
+            moves |= JUMP_FROM_RIGHT;
+        if (canMove(slab, STEP_FROM_LEFT))
+            moves |= STEP_FROM_LEFT;
+        if (canMove(slab, STEP_FROM_RIGHT))
+            moves |= STEP_FROM_RIGHT;
+
+        return moves;
+    }
+
+    // Swaps two cells, one of which is empty: both bits flip in the bitboard that holds the frog
+    void swapCells(size_t first, size_t second)
+    {
+        uint64_t cells = uint64_t(1) << (first + PADDING) | uint64_t(1) << (second + PADDING);
+        uint64_t leftCells = cells & (0 - (uint64_t)((leftFrogs & cells) != 0));
+        leftFrogs ^= leftCells;
+        rightFrogs ^= cells ^ leftCells;
+    }
+
+    bool operator==(const SmallPackedBoard& other) const
+    {
+        return leftFrogs == other.leftFrogs && rightFrogs == other.rightFrogs;
+    }
+
+    bool operator!=(const SmallPackedBoard& other) const
+    {
+        return !(*this == other);
+    }
+
+    void render(std::string& cells, char left, char right, char space) const
+    {
+        cells.resize(size());
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            if (isLeftFrog(i))
+                cells[i] = left;
+            else if (isRightFrog(i))
+                cells[i] = right;
+            else
+                cells[i] = space;
+        }
+    }
+};
+
+struct PackedBoardHash
+{
+    size_t operator()(const PackedBoard& board) const
+    {
+        return board.hash();
+    }
+};
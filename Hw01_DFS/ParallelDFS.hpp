@@ -0,0 +1,146 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "PackedBoard.hpp"
+#include "IterativeDFS.hpp"
+#include "WorkStealingPool.hpp"
+
+/*
+    Frontier-split DFS: the first levels of the search tree are expanded serially into independent
+    subproblems (a board and the slab positions that led to it), which are then searched with
+    IterativeDFS on a work-stealing pool. The first worker to reach the goal raises a shared flag
+    and the rest stop at their next cancellation check.
+    Board is PackedBoard or, when the board fits, SmallPackedBoard.
+*/
+template <class Board>
+class ParallelDFS
+{
+    // Auto split depth aims for this many subproblems per thread so stealing can even out the subtrees
+    static const size_t TASKS_PER_THREAD = 8;
+    static const size_t MAX_SPLIT_DEPTH = 32;
+
+    struct Subproblem
+    {
+        Board board;
+        std::vector<size_t> prefix;
+    };
+
+    Board startBoard;
+    size_t startSlabPosition;
+    size_t goalDepth;
+
+    std::atomic<bool> isFound{ false };
+    std::atomic<size_t> nodesCount{ 0 };
+    std::mutex resultLock;
+    std::vector<size_t> path;
+
+    void expandFrontier(Board& board, std::vector<size_t>& prefix, size_t levels, std::vector<Subproblem>& frontier) const
+    {
+        if (levels == 0 || prefix.size() == goalDepth)
+        {
+            frontier.push_back({ board, prefix });
+            return;
+        }
+
+        static const int OFFSETS[] = { -2, 2, -1, 1 };
+        size_t slabPosition = prefix.back();
+        unsigned moves = board.getMoves(slabPosition);
+        for (unsigned i = 0; i < 4; i++)
+        {
+            if (!(moves & (1u << i)))
+                continue;
+
+            size_t nextSlabPosition = slabPosition + OFFSETS[i];
+            board.swapCells(nextSlabPosition, slabPosition);
+            prefix.push_back(nextSlabPosition);
+
+            expandFrontier(board, prefix, levels - 1, frontier);
+
+            prefix.pop_back();
+            board.swapCells(nextSlabPosition, slabPosition);
+        }
+    }
+
+    std::vector<Subproblem> buildFrontier(size_t splitDepth, size_t threadsCount) const
+    {
+        Board board = startBoard;
+        std::vector<size_t> prefix = { startSlabPosition };
+        std::vector<Subproblem> frontier;
+
+        if (splitDepth > 0)
+        {
+            expandFrontier(board, prefix, splitDepth, frontier);
+            return frontier;
+        }
+
+        // Auto: go one level deeper until there is enough work for every thread (or the tree ends)
+        size_t levels = 0;
+        do
+        {
+            levels++;
+            frontier.clear();
+            expandFrontier(board, prefix, levels, frontier);
+        } while (frontier.size() < TASKS_PER_THREAD * threadsCount && levels + 1 < goalDepth && levels < MAX_SPLIT_DEPTH);
+
+        return frontier;
+    }
+
+    void solveSubproblem(const Subproblem& subproblem)
+    {
+        if (isFound.load(std::memory_order_relaxed))
+            return;
+
+        IterativeDFS<Board> search(subproblem.board, subproblem.prefix.back(), goalDepth - subproblem.prefix.size() + 1);
+        bool isSolved = search.search(&isFound);
+        nodesCount += search.getNodesCount();
+
+        if (!isSolved || isFound.exchange(true))
+            return;
+
+        std::lock_guard<std::mutex> guard(resultLock);
+        path = subproblem.prefix;
+        const std::vector<SearchFrame>& tail = search.getPath();
+        for (size_t i = 1; i < tail.size(); i++)
+            path.push_back(tail[i].slabPosition);
+    }
+
+public:
+    ParallelDFS(const Board& board, size_t slabPosition, size_t goalDepth)
+        : startBoard(board), startSlabPosition(slabPosition), goalDepth(goalDepth)
+    { }
+
+    // splitDepth = 0 picks the number of expanded levels automatically
+    bool search(WorkStealingPool& pool, size_t splitDepth = 0)
+    {
+        isFound = false;
+        nodesCount = 0;
+        path.clear();
+
+        if (goalDepth == 0)
+            return false;
+
+        std::vector<Subproblem> frontier = buildFrontier(splitDepth, pool.getThreadsCount());
+        for (const auto& subproblem : frontier)
+        {
+            pool.submit([this, &subproblem] { solveSubproblem(subproblem); });
+        }
+        pool.wait();
+
+        return isFound;
+    }
+
+    // The slab position of every state on the found path, from the start to the goal
+    const std::vector<size_t>& getPath() const
+    {
+        return path;
+    }
+
+    size_t getNodesCount() const
+    {
+        return nodesCount;
+    }
+};
@@ -0,0 +1,102 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <functional>
+#include <type_traits>
+
+#include "PackedBoard.hpp"
+
+/*
+    The recursive DFS of Solution 1: the goal is checked at every node and the path is
+    printed while the recursion unwinds, so the states come out from the goal back to the start.
+    Board is PackedBoard or, when the board fits, SmallPackedBoard. A SmallPackedBoard is passed down
+    by value, so every call keeps its board in registers and a move never waits on memory;
+    a PackedBoard is shared by reference and every move is undone on the way back.
+*/
+template <class Board>
+class RecursiveDFS
+{
+    using BoardParameter = typename std::conditional<std::is_trivially_copyable<Board>::value, Board, Board&>::type;
+
+    Board start;
+    Board goal;
+    std::function<void(const Board&)> print;
+    size_t nodesCount = 0;
+
+    bool nextStep(BoardParameter board, size_t slabPosition, size_t nextSlabPosition)
+    {
+        board.swapCells(nextSlabPosition, slabPosition);
+        bool isSolved = performStep(board, nextSlabPosition);
+        board.swapCells(nextSlabPosition, slabPosition);
+
+        if (isSolved)
+        {
+            print(board);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool performStep(BoardParameter board, size_t slabPosition)
+    {
+        nodesCount++;
+
+        if (board == goal)
+        {
+            print(board);
+            return true;
+        }
+
+        if (board.canMove(slabPosition, JUMP_FROM_LEFT))
+        {
+            if (nextStep(board, slabPosition, slabPosition - 2))
+            {
+                return true;
+            }
+        }
+
+        if (board.canMove(slabPosition, JUMP_FROM_RIGHT))
+        {
+            if (nextStep(board, slabPosition, slabPosition + 2))
+            {
+                return true;
+            }
+        }
+
+        if (board.canMove(slabPosition, STEP_FROM_LEFT))
+        {
+            if(nextStep(board, slabPosition, slabPosition - 1))
+            {
+                return true;
+            }
+        }
+
+        if (board.canMove(slabPosition, STEP_FROM_RIGHT))
+        {
+            if(nextStep(board, slabPosition, slabPosition + 1))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+public:
+    RecursiveDFS(const Board& start, const Board& goal, std::function<void(const Board&)> print)
+        : start(start), goal(goal), print(print)
+    { }
+
+    bool search(size_t slabPosition)
+    {
+        nodesCount = 0;
+        Board board = start;
+        return performStep(board, slabPosition);
+    }
+
+    size_t getNodesCount() const
+    {
+        return nodesCount;
+    }
+};
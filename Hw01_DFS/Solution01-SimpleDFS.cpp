@@ -2,118 +2,86 @@
 // Solution 1 - Simple DFS solution with code reuse
 #include <iostream>
 #include <chrono>
+#include <string>
+
+#include "BulkOutput.hpp"
+#include "PackedBoard.hpp"
+#include "RecursiveDFS.hpp"
 
 const char LEFT = '<';
 const char RIGHT = '>';
 const char SPACE = '_';
 
-void fillBoard(char* board, size_t boardSize)
+TraceWriter traceWriter;
+
+std::string fillBoard(size_t boardSize)
 {
+    std::string board(2 * boardSize + 1, SPACE);
     for (size_t i = 0; i < boardSize; i++)
     {
         board[i] = LEFT;
         board[2 * boardSize - i] = RIGHT;
     }
 
-    board[boardSize] = SPACE;
-    board[boardSize * 2 + 1] = '\0';
-}
-
-void print(char* board)
-{
-    std::cout << board << std::endl;
+    return board;
 }
 
-bool isGoalState(const char* board, size_t boardSize)
+template <class Board>
+void print(const Board& board)
 {
-    for (size_t i = 0; i < boardSize; i++)
+    static std::string cells;
+    if (!traceWriter.needsText())
     {
-        if (board[i] != RIGHT || board[2 * boardSize - i] != LEFT)
-        {
-            return false;
-        }
+        traceWriter.countLine(board.size());
+        return;
     }
 
-    return board[boardSize] == SPACE;
+    board.render(cells, LEFT, RIGHT, SPACE);
+    traceWriter.writeLine(cells.c_str(), cells.size());
 }
 
-bool performStep(char* board, size_t boardSize, int slabPosition);
-
-bool nextStep(char* board, size_t boardSize, int slabPosition, int offset)
+template <class Board>
+void findPath(const std::string& cells, size_t boardSize)
 {
-    std::swap(board[slabPosition + offset], board[slabPosition]);
-    bool isSolved = performStep(board, boardSize, slabPosition + offset);
-    std::swap(board[slabPosition + offset], board[slabPosition]);
+    Board board(cells, LEFT, RIGHT);
+    Board goal(std::string(cells.rbegin(), cells.rend()), LEFT, RIGHT);
 
-    if (isSolved)
-    {
-        print(board);
-        return true;
-    }
-
-    return false;
+    RecursiveDFS<Board> search(board, goal, print<Board>);
+    search.search(boardSize);
 }
 
-bool performStep(char* board, size_t boardSize, int slabPosition)
+int main(int argc, char** argv)
 {
-    if (isGoalState(board, boardSize / 2))
-    {
-        print(board);
-        return true;
-    }
-
-    if (slabPosition - 2 >= 0 && board[slabPosition - 2] == LEFT && board[slabPosition - 1] != LEFT)
-    {
-        if (nextStep(board, boardSize, slabPosition, -2))
-        {
-            return true;
-        }
-    }
+    std::string outputPath;
+    OutputMode mode;
+    if (!parseOutputMode(argc, argv, mode, outputPath))
+        return 1;
 
-    if (slabPosition + 2 < boardSize && board[slabPosition + 2] == RIGHT && board[slabPosition + 1] != RIGHT)
+    if (!traceWriter.open(mode, outputPath))
     {
-        if (nextStep(board, boardSize, slabPosition, 2))
-        {
-            return true;
-        }
+        std::cerr << "Cannot open " << outputPath << std::endl;
+        return 1;
     }
 
-    if (slabPosition - 1 >= 0 && board[slabPosition - 1] == LEFT)
-    {
-        if(nextStep(board, boardSize, slabPosition, -1))
-        {
-            return true;
-        }
-    }
-
-    if (slabPosition + 1 < boardSize && board[slabPosition + 1] == RIGHT)
-    {
-        if(nextStep(board, boardSize, slabPosition, 1))
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-void findPath(char* board, size_t boardSize)
-{
-    performStep(board, 2 * boardSize + 1, boardSize);
-}
-
-int main()
-{
     size_t boardSize = 0;
     std::cin >> boardSize;
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    char* board = new char[boardSize * 2 + 2];
-    fillBoard(board, boardSize);
-    findPath(board, boardSize);
+    std::string board = fillBoard(boardSize);
+    if (board.size() <= SmallPackedBoard::MAX_CELLS)
+        findPath<SmallPackedBoard>(board, boardSize);
+    else
+        findPath<PackedBoard>(board, boardSize);
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
     // std::cout << "Time to compute and print: " << duration.count() << " seconds";
+
+    traceWriter.close();
+    if (mode == OutputMode::CountOnly)
+    {
+        std::cout << "# STATES: " << traceWriter.getLinesCount() << std::endl;
+        std::cout << "# TIMES_MS: alg=" << duration.count() * 1000 << std::endl;
+    }
 }
\ No newline at end of file
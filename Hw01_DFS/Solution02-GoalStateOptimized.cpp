@@ -1,109 +1,101 @@
 // Ivan Makaveev, 2MI0600203
-// Solution 2 - Optimized goal state and lowered number of recursive function calls
+// Solution 2 - Optimized goal state and an iterative DFS with an explicit stack instead of recursion
 #include <iostream>
 #include <chrono>
+#include <string>
+#include <vector>
+
+#include "BulkOutput.hpp"
+#include "PackedBoard.hpp"
+#include "IterativeDFS.hpp"
 
 const char LEFT = '<';
 const char RIGHT = '>';
 const char SPACE = '_';
 
-void fillBoard(char* board, size_t boardSize)
+TraceWriter traceWriter;
+
+std::string fillBoard(size_t boardSize)
 {
+    std::string board(2 * boardSize + 1, SPACE);
     for (size_t i = 0; i < boardSize; i++)
     {
         board[i] = LEFT;
         board[2 * boardSize - i] = RIGHT;
     }
 
-    board[boardSize] = SPACE;
-    board[boardSize * 2 + 1] = '\0';
+    return board;
 }
 
-void print(char* board)
+template <class Board>
+void print(const Board& board)
 {
-    std::cout << board << std::endl;
+    static std::string cells;
+    if (!traceWriter.needsText())
+    {
+        traceWriter.countLine(board.size());
+        return;
+    }
+
+    board.render(cells, LEFT, RIGHT, SPACE);
+    traceWriter.writeLine(cells.c_str(), cells.size());
 }
 
-bool performStep(char* board, size_t boardSize, int slabPosition, size_t depth, size_t goalDepth)
+// Replays the path kept on the search stack, printing the states from the start to the goal
+template <class Board>
+void printPath(Board board, const std::vector<SearchFrame>& path)
 {
-    if (depth == goalDepth)
+    print(board);
+    for (size_t i = 1; i < path.size(); i++)
     {
+        board.swapCells(path[i - 1].slabPosition, path[i].slabPosition);
         print(board);
-        return true;
-    }
-
-    if (slabPosition - 2 >= 0 && board[slabPosition - 2] == LEFT && board[slabPosition - 1] != LEFT)
-    {
-        std::swap(board[slabPosition - 2], board[slabPosition]);
-        bool isSolved = performStep(board, boardSize, slabPosition - 2, depth + 1, goalDepth);
-        std::swap(board[slabPosition - 2], board[slabPosition]);
-    
-        if (isSolved)
-        {
-            print(board);
-            return true;
-        }
     }
+}
 
-    if (slabPosition + 2 < boardSize && board[slabPosition + 2] == RIGHT && board[slabPosition + 1] != RIGHT)
+template <class Board>
+void findPath(const std::string& cells, size_t boardSize)
+{
+    Board board(cells, LEFT, RIGHT);
+    IterativeDFS<Board> search(board, boardSize, (boardSize + 1) * (boardSize + 1));
+    if (search.search())
     {
-        std::swap(board[slabPosition + 2], board[slabPosition]);
-        bool isSolved = performStep(board, boardSize, slabPosition + 2, depth + 1, goalDepth);
-        std::swap(board[slabPosition + 2], board[slabPosition]);
-
-        if (isSolved)
-        {
-            print(board);
-            return true;
-        }
+        printPath(board, search.getPath());
     }
+}
 
-    if (slabPosition - 1 >= 0 && board[slabPosition - 1] == LEFT)
-    {
-        std::swap(board[slabPosition - 1], board[slabPosition]);
-        bool isSolved = performStep(board, boardSize, slabPosition - 1, depth + 1, goalDepth);
-        std::swap(board[slabPosition - 1], board[slabPosition]);
-    
-        if (isSolved)
-        {
-            print(board);
-            return true;
-        }
-    }
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    OutputMode mode;
+    if (!parseOutputMode(argc, argv, mode, outputPath))
+        return 1;
 
-    if (slabPosition + 1 < boardSize && board[slabPosition + 1] == RIGHT)
+    if (!traceWriter.open(mode, outputPath))
     {
-        std::swap(board[slabPosition + 1], board[slabPosition]);
-        bool isSolved = performStep(board, boardSize, slabPosition + 1, depth + 1, goalDepth);
-        std::swap(board[slabPosition + 1], board[slabPosition]);
-    
-        if (isSolved)
-        {
-            print(board);
-            return true;
-        }
+        std::cerr << "Cannot open " << outputPath << std::endl;
+        return 1;
     }
 
-    return false;
-}
-
-void findPath(char* board, size_t boardSize)
-{
-    performStep(board, 2 * boardSize + 1, boardSize, 1, (boardSize + 1) * (boardSize + 1));
-}
-
-int main()
-{
     size_t boardSize = 0;
     std::cin >> boardSize;
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    char* board = new char[boardSize * 2 + 2];
-    fillBoard(board, boardSize);
-    findPath(board, boardSize);
+    std::string board = fillBoard(boardSize);
+    if (board.size() <= SmallPackedBoard::MAX_CELLS)
+        findPath<SmallPackedBoard>(board, boardSize);
+    else
+        findPath<PackedBoard>(board, boardSize);
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
     // std::cout << "Time to compute and print: " << duration.count() << " seconds";
+
+    traceWriter.close();
+    if (mode == OutputMode::CountOnly)
+    {
+        std::cout << "# STATES: " << traceWriter.getLinesCount() << std::endl;
+        std::cout << "# TIMES_MS: alg=" << duration.count() * 1000 << std::endl;
+    }
 }
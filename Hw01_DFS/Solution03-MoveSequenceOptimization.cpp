@@ -2,158 +2,69 @@
 // Solution 3 - Rule-based solution by simulating only the exact moves
 #include <iostream>
 #include <chrono>
+#include <string>
+
+#include "BulkOutput.hpp"
+#include "MoveSequence.hpp"
 
 const char RIGHT = '<';
 const char LEFT = '>';
 const char SPACE = '_';
 
-void fillBoard(char* board, size_t boardSize)
+TraceWriter traceWriter;
+
+std::string fillBoard(size_t boardSize)
 {
+    std::string board(2 * boardSize + 1, SPACE);
     for (size_t i = 0; i < boardSize; i++)
     {
         board[i] = LEFT;
         board[2 * boardSize - i] = RIGHT;
     }
 
-    board[boardSize] = SPACE;
-    board[boardSize * 2 + 1] = '\0';
+    return board;
 }
 
-void print(char* board)
+void print(const std::string& board)
 {
-    std::cout << board << std::endl;
+    traceWriter.writeLine(board.c_str(), board.size());
 }
 
-void smallLeftStep(char* board, size_t boardSize, size_t& slabPosition)
+void findPath(const std::string& board, size_t boardSize)
 {
-    std::swap(board[slabPosition - 1], board[slabPosition]);
-    print(board);
-    slabPosition -= 1;
+    MoveSequenceSolver solver(board, boardSize, print);
+    solver.findPath();
 }
 
-void smallRightStep(char* board, size_t boardSize, size_t& slabPosition)
+int main(int argc, char** argv)
 {
-    std::swap(board[slabPosition + 1], board[slabPosition]);
-    print(board);
-    slabPosition += 1;
-}
-
-void bigLeftStep(char* board, size_t boardSize, size_t& slabPosition)
-{
-    std::swap(board[slabPosition - 2], board[slabPosition]);
-    print(board);
-    slabPosition -= 2;
-}
-
-void bigRightStep(char* board, size_t boardSize, size_t& slabPosition)
-{
-    std::swap(board[slabPosition + 2], board[slabPosition]);
-    print(board);
-    slabPosition += 2;
-}
-
-void performRightStep(char* board, size_t boardSize, size_t& slabPosition, size_t moveCount, bool reverse)
-{
-    if (reverse)
-    {
-        smallRightStep(board, boardSize, slabPosition);
-    }
+    std::string outputPath;
+    OutputMode mode;
+    if (!parseOutputMode(argc, argv, mode, outputPath))
+        return 1;
 
-    for (size_t i = 1; i < moveCount; i++)
+    if (!traceWriter.open(mode, outputPath))
     {
-        bigRightStep(board, boardSize, slabPosition);
+        std::cerr << "Cannot open " << outputPath << std::endl;
+        return 1;
     }
 
-    if (!reverse)
-    {
-        smallRightStep(board, boardSize, slabPosition);
-    }
-}
-
-void performLeftStep(char* board, size_t boardSize, size_t& slabPosition, size_t moveCount, bool reverse)
-{
-    if (reverse)
-    {
-        smallLeftStep(board, boardSize, slabPosition);
-    }
-
-    for (size_t i = 1; i < moveCount; i++)
-    {
-        bigLeftStep(board, boardSize, slabPosition);
-    }
-
-    if (!reverse)
-    {
-        smallLeftStep(board, boardSize, slabPosition);
-    }
-}
-
-void performMiddleStep(char* board, size_t boardSize, size_t& slabPosition, size_t moveCount, bool isLeft)
-{
-    if (isLeft)
-    {
-        for (size_t i = 0; i < moveCount; i++)
-        {
-            bigLeftStep(board, boardSize, slabPosition);
-        }
-    }
-    else
-    {
-        for (size_t i = 0; i < moveCount; i++)
-        {
-            bigRightStep(board, boardSize, slabPosition);
-        }
-    }
-}
-
-void findPath(char* board, size_t boardSize)
-{
-    print(board);
-
-    bool isNextMoveLeft = true;
-    size_t slabPosition = boardSize;
-    for (size_t i = 1; i <= boardSize; i++)
-    {
-        if (isNextMoveLeft)
-        {
-            performLeftStep(board, 2 * boardSize + 1, slabPosition, i, false);
-        }
-        else
-        {
-            performRightStep(board, 2 * boardSize + 1, slabPosition, i, false);
-        }
-        isNextMoveLeft = !isNextMoveLeft;
-    }
-
-    performMiddleStep(board, 2 * boardSize + 1, slabPosition, boardSize, isNextMoveLeft);
-    isNextMoveLeft = !isNextMoveLeft;
-
-    for (size_t i = boardSize; i >= 1; i--)
-    {
-        if (isNextMoveLeft)
-        {
-            performLeftStep(board, 2 * boardSize + 1, slabPosition, i, true);
-        }
-        else
-        {
-            performRightStep(board, 2 * boardSize + 1, slabPosition, i, true);
-        }
-        isNextMoveLeft = !isNextMoveLeft;
-    }
-}
-
-int main()
-{
     size_t boardSize = 0;
     std::cin >> boardSize;
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    char* board = new char[boardSize * 2 + 2];
-    fillBoard(board, boardSize);
+    std::string board = fillBoard(boardSize);
     findPath(board, boardSize);
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
     // std::cout << "Time to compute and print: " << duration.count() << " seconds";
+
+    traceWriter.close();
+    if (mode == OutputMode::CountOnly)
+    {
+        std::cout << "# STATES: " << traceWriter.getLinesCount() << std::endl;
+        std::cout << "# TIMES_MS: alg=" << duration.count() * 1000 << std::endl;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+// Ivan Makaveev, 2MI0600203
+// Solution 4 - Closed-form generator of the rule-based moves, printing any range of the trace
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "BulkOutput.hpp"
+#include "FrogMoveGenerator.hpp"
+
+// Approximate size of the text each thread renders before the blocks are written out
+const size_t THREAD_BLOCK_BYTES = 1 << 22;
+
+TraceWriter traceWriter;
+
+// Renders the boards for states [fromState, toState] as newline-terminated lines
+void renderStates(const FrogMoveGenerator& generator, uint64_t fromState, uint64_t toState, std::vector<char>& output)
+{
+    size_t lineLength = generator.getBoardLength() + 1;
+    output.resize((toState - fromState + 1) * lineLength);
+
+    char* line = output.data();
+    generator.fillBoard(fromState, line);
+    line[lineLength - 1] = '\n';
+
+    for (uint64_t state = fromState + 1; state <= toState; state++)
+    {
+        char* nextLine = line + lineLength;
+        std::copy(line, nextLine, nextLine);
+        FrogMoveGenerator::applyMove(nextLine, generator.getMove(state - 1));
+        line = nextLine;
+    }
+}
+
+void printStates(const FrogMoveGenerator& generator, uint64_t fromState, uint64_t toState, size_t threadsCount)
+{
+    // In CountOnly mode the states are only counted, as the DFS solvers skip their text
+    if (!traceWriter.needsText())
+    {
+        traceWriter.countLines(toState - fromState + 1, generator.getBoardLength());
+        return;
+    }
+
+    size_t lineLength = generator.getBoardLength() + 1;
+    uint64_t statesPerThread = std::max<uint64_t>(1, THREAD_BLOCK_BYTES / lineLength);
+
+    std::vector<std::vector<char>> blocks(threadsCount);
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount);
+
+    uint64_t state = fromState;
+    while (state <= toState)
+    {
+        // Each round splits the next move-index range between the threads and writes the blocks in order
+        size_t usedBlocks = 0;
+        for (size_t i = 0; i < threadsCount && state <= toState; i++)
+        {
+            uint64_t lastState = std::min(toState, state + statesPerThread - 1);
+            workers.emplace_back(renderStates, std::cref(generator), state, lastState, std::ref(blocks[i]));
+            state = lastState + 1;
+            usedBlocks++;
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+        workers.clear();
+
+        for (size_t i = 0; i < usedBlocks; i++)
+            traceWriter.writeLines(blocks[i].data(), blocks[i].size(), blocks[i].size() / lineLength);
+    }
+}
+
+/*
+    Command line: [--from <state>] [--to <state>] [--threads <count>] plus the output flags from BulkOutput.hpp
+    States are numbered from 0 (start board) to N * (N + 2) (goal board).
+*/
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    OutputMode mode;
+    if (!parseOutputMode(argc, argv, mode, outputPath, { "--from", "--to", "--threads" }))
+        return 1;
+
+    if (!traceWriter.open(mode, outputPath))
+    {
+        std::cerr << "Cannot open " << outputPath << std::endl;
+        return 1;
+    }
+
+    uint64_t fromState = 0;
+    uint64_t toState = UINT64_MAX;
+    size_t threadsCount = 1;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--from")
+            fromState = std::stoull(argv[++i]);
+        else if (arg == "--to")
+            toState = std::stoull(argv[++i]);
+        else if (arg == "--threads")
+            threadsCount = std::max(1, std::stoi(argv[++i]));
+    }
+
+    uint64_t boardSize = 0;
+    std::cin >> boardSize;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    FrogMoveGenerator generator(boardSize);
+    toState = std::min(toState, generator.getMovesCount());
+    if (fromState <= toState)
+    {
+        printStates(generator, fromState, toState, threadsCount);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    traceWriter.close();
+    if (mode == OutputMode::CountOnly)
+    {
+        std::cout << "# STATES: " << traceWriter.getLinesCount() << std::endl;
+        std::cout << "# TIMES_MS: alg=" << duration.count() * 1000 << std::endl;
+    }
+}
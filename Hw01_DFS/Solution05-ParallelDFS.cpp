@@ -0,0 +1,118 @@
+// Ivan Makaveev, 2MI0600203
+// Solution 5 - DFS split into subtrees after the first levels and searched on all cores
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BulkOutput.hpp"
+#include "PackedBoard.hpp"
+#include "ParallelDFS.hpp"
+#include "WorkStealingPool.hpp"
+
+const char LEFT = '<';
+const char RIGHT = '>';
+const char SPACE = '_';
+
+TraceWriter traceWriter;
+
+std::string fillBoard(size_t boardSize)
+{
+    std::string board(2 * boardSize + 1, SPACE);
+    for (size_t i = 0; i < boardSize; i++)
+    {
+        board[i] = LEFT;
+        board[2 * boardSize - i] = RIGHT;
+    }
+
+    return board;
+}
+
+template <class Board>
+void print(const Board& board)
+{
+    static std::string cells;
+    if (!traceWriter.needsText())
+    {
+        traceWriter.countLine(board.size());
+        return;
+    }
+
+    board.render(cells, LEFT, RIGHT, SPACE);
+    traceWriter.writeLine(cells.c_str(), cells.size());
+}
+
+template <class Board>
+void printPath(Board board, const std::vector<size_t>& path)
+{
+    print(board);
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        board.swapCells(path[i - 1], path[i]);
+        print(board);
+    }
+}
+
+template <class Board>
+void findPath(const std::string& cells, size_t boardSize, size_t threadsCount, size_t splitDepth)
+{
+    Board board(cells, LEFT, RIGHT);
+    WorkStealingPool pool(threadsCount);
+
+    ParallelDFS<Board> search(board, boardSize, (boardSize + 1) * (boardSize + 1));
+    if (search.search(pool, splitDepth))
+    {
+        printPath(board, search.getPath());
+    }
+}
+
+/*
+    Command line: [--threads <count>] [--split-depth <levels>] plus the output flags from BulkOutput.hpp
+    By default all hardware threads are used and the split depth is chosen automatically.
+*/
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    OutputMode mode;
+    if (!parseOutputMode(argc, argv, mode, outputPath, { "--threads", "--split-depth" }))
+        return 1;
+
+    if (!traceWriter.open(mode, outputPath))
+    {
+        std::cerr << "Cannot open " << outputPath << std::endl;
+        return 1;
+    }
+
+    size_t threadsCount = std::thread::hardware_concurrency();
+    size_t splitDepth = 0;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--threads")
+            threadsCount = std::stoul(argv[++i]);
+        else if (arg == "--split-depth")
+            splitDepth = std::stoul(argv[++i]);
+    }
+
+    size_t boardSize = 0;
+    std::cin >> boardSize;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::string board = fillBoard(boardSize);
+    if (board.size() <= SmallPackedBoard::MAX_CELLS)
+        findPath<SmallPackedBoard>(board, boardSize, threadsCount, splitDepth);
+    else
+        findPath<PackedBoard>(board, boardSize, threadsCount, splitDepth);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    traceWriter.close();
+    if (mode == OutputMode::CountOnly)
+    {
+        std::cout << "# STATES: " << traceWriter.getLinesCount() << std::endl;
+        std::cout << "# TIMES_MS: alg=" << duration.count() * 1000 << std::endl;
+    }
+}
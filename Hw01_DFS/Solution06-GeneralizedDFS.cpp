@@ -0,0 +1,120 @@
+// Ivan Makaveev, 2MI0600203
+// Solution 6 - DFS with a transposition table for any start and goal board (uneven sides, several gaps)
+#include <iostream>
+#include <chrono>
+#include <string>
+
+#include "BulkOutput.hpp"
+#include "GeneralizedDFS.hpp"
+#include "PackedBoard.hpp"
+
+const char LEFT = '>';
+const char RIGHT = '<';
+const char SPACE = '_';
+
+TraceWriter traceWriter;
+
+void print(const PackedBoard& board)
+{
+    static std::string cells;
+    if (!traceWriter.needsText())
+    {
+        traceWriter.countLine(board.size());
+        return;
+    }
+
+    board.render(cells, LEFT, RIGHT, SPACE);
+    traceWriter.writeLine(cells.c_str(), cells.size());
+}
+
+// Both boards must be made of the same cells - only the frogs' positions may differ
+bool isValidPair(const std::string& start, const std::string& goal)
+{
+    if (start.size() != goal.size())
+        return false;
+
+    int leftBalance = 0;
+    int rightBalance = 0;
+    for (size_t i = 0; i < start.size(); i++)
+    {
+        if (start[i] != LEFT && start[i] != RIGHT && start[i] != SPACE)
+            return false;
+        if (goal[i] != LEFT && goal[i] != RIGHT && goal[i] != SPACE)
+            return false;
+
+        leftBalance += (start[i] == LEFT) - (goal[i] == LEFT);
+        rightBalance += (start[i] == RIGHT) - (goal[i] == RIGHT);
+    }
+
+    return leftBalance == 0 && rightBalance == 0;
+}
+
+bool findPath(const std::string& startCells, const std::string& goalCells, size_t visitedLimit, size_t& nodesCount)
+{
+    PackedBoard start(startCells, LEFT, RIGHT);
+    PackedBoard goal(goalCells, LEFT, RIGHT);
+
+    GeneralizedDFS search(start, goal, visitedLimit);
+    bool isSolved = search.search();
+    nodesCount = search.getNodesCount();
+
+    if (isSolved)
+    {
+        search.forEachState(start, print);
+    }
+
+    return isSolved;
+}
+
+/*
+    Input: the start board and the goal board on separate lines, e.g.
+        >>_>_<<
+        <<_>_>>
+    '>' frogs move right, '<' frogs move left and '_' is a gap.
+    Command line: [--tt-limit <boards>] plus the output flags from BulkOutput.hpp
+*/
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    OutputMode mode;
+    if (!parseOutputMode(argc, argv, mode, outputPath, { "--tt-limit" }))
+        return 1;
+
+    if (!traceWriter.open(mode, outputPath))
+    {
+        std::cerr << "Cannot open " << outputPath << std::endl;
+        return 1;
+    }
+
+    size_t visitedLimit = SIZE_MAX;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--tt-limit")
+            visitedLimit = std::stoull(argv[++i]);
+    }
+
+    std::string startCells;
+    std::string goalCells;
+    std::cin >> startCells >> goalCells;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t nodesCount = 0;
+    bool isSolved = isValidPair(startCells, goalCells) && findPath(startCells, goalCells, visitedLimit, nodesCount);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    traceWriter.close();
+    if (!isSolved)
+    {
+        std::cout << -1 << std::endl;
+    }
+
+    if (mode == OutputMode::CountOnly)
+    {
+        std::cout << "# STATES: " << traceWriter.getLinesCount() << std::endl;
+        std::cout << "# NODES: " << nodesCount << std::endl;
+        std::cout << "# TIMES_MS: alg=" << duration.count() * 1000 << std::endl;
+    }
+}
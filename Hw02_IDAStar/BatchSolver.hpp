@@ -0,0 +1,199 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "BoardState.hpp"
+#include "Heuristics.hpp"
+#include "IDAStar.hpp"
+#include "Puzzle.hpp"
+#include "SearchStats.hpp"
+#include "TranspositionTable.hpp"
+#include "WorkStealingPool.hpp"
+
+/*
+	Solves a stream of puzzles on a thread pool and prints the results in input order.
+	Puzzles are read one at a time and at most `maxPending` of them are held at once (queued, being solved,
+	or solved and waiting for an earlier one to be printed), so the input can be of any length.
+	Every puzzle is searched serially on one worker; each worker thread keeps its path buffer and transposition table
+	between puzzles, and the heuristic tables are built once per board size and goal and shared by all workers.
+*/
+class BatchSolver
+{
+	struct Result
+	{
+		bool isSolved = false;
+		std::vector<uint8_t> path;
+		double milliseconds = 0;
+		uint64_t nodesCount = 0;
+		SearchStats stats;
+		std::string error;
+	};
+
+	HeuristicType heuristicType;
+	std::string patternDirectory;
+	WorkStealingPool& pool;
+	std::ostream& output;
+	size_t maxPending;
+	bool orderMoves;
+	size_t transpositionsSize;
+	unsigned weight;
+
+	struct TablesEntry
+	{
+		std::unique_ptr<HeuristicTables> tables;
+		std::string error;
+	};
+
+	std::mutex tablesLock;
+	std::map<std::tuple<size_t, size_t, unsigned>, TablesEntry> tables;  // by rows, columns and goal of the empty tile
+
+	std::mutex resultsLock;
+	std::condition_variable resultsChanged;
+	std::map<size_t, Result> finished;
+	size_t nextToPrint = 0;
+	size_t pendingCount = 0;
+
+	// Building a pattern database takes a while, so the lock is held for the whole load and the other workers wait for it
+	const HeuristicTables* getTables(size_t rows, size_t cols, unsigned emptyTileTarget, std::string& error)
+	{
+		std::lock_guard<std::mutex> guard(tablesLock);
+		TablesEntry& entry = tables[std::make_tuple(rows, cols, emptyTileTarget)];
+		if (!entry.tables && entry.error.empty())
+		{
+			entry.tables.reset(new HeuristicTables());
+			if (!entry.tables->load(heuristicType, rows, cols, emptyTileTarget, patternDirectory, entry.error))
+				entry.tables.reset();
+			else
+				entry.tables->weight = weight;
+		}
+
+		error = entry.error;
+		return entry.tables.get();
+	}
+
+	Result solve(const Puzzle& puzzle)
+	{
+		thread_local std::vector<uint8_t> path;
+		thread_local std::unique_ptr<TranspositionTable> transpositions;
+		path.clear();
+
+		Result result;
+		if (!puzzle.isSupported())
+		{
+			result.error = "Unsupported board";
+			return result;
+		}
+
+		const HeuristicTables* heuristic = getTables(puzzle.rows, puzzle.cols, puzzle.emptyTileTarget, result.error);
+		if (!heuristic)
+			return result;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		if (hasSolution(puzzle.board, puzzle.cols, puzzle.emptyTilePos, puzzle.emptyTileTarget))
+		{
+			BoardState root(puzzle.board, puzzle.rows, puzzle.cols, puzzle.emptyTilePos, puzzle.emptyTileTarget, 0, heuristic);
+			root.calculateHeuristic();
+
+			IDAStarOptions options;
+			options.orderMoves = orderMoves;
+			if (transpositionsSize)
+			{
+				if (!transpositions)
+					transpositions.reset(new TranspositionTable(transpositionsSize));
+				options.transpositions = transpositions.get();
+			}
+
+			result.isSolved = solveIDAStar(root, path, result.stats, 0, options);
+			result.nodesCount = root.nodesCount;
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		std::chrono::duration<double, std::milli> duration = end - start;
+		result.milliseconds = duration.count();
+		result.path = path;
+		return result;
+	}
+
+	void print(size_t index, const Result& result)
+	{
+		output << "# INSTANCE: " << index << '\n';
+		if (!result.error.empty())
+		{
+			output << "# ERROR: " << result.error << '\n' << -1 << '\n';
+			return;
+		}
+
+		output << "# TIMES_MS: alg=" << result.milliseconds << '\n';
+		output << "# NODES: " << result.nodesCount << '\n';
+		result.stats.print(output, (unsigned)result.path.size());
+		if (!result.isSolved)
+		{
+			output << -1 << '\n';
+			return;
+		}
+
+		output << result.path.size() << '\n';
+		for (uint8_t move : result.path)
+			output << MOVE_NAMES[move] << '\n';
+	}
+
+	// Prints every result that is next in line; whoever finishes the oldest pending puzzle does the printing
+	void finish(size_t index, Result&& result)
+	{
+		std::lock_guard<std::mutex> guard(resultsLock);
+		finished.emplace(index, std::move(result));
+
+		for (auto next = finished.find(nextToPrint); next != finished.end(); next = finished.find(nextToPrint))
+		{
+			print(next->first, next->second);
+			finished.erase(next);
+			nextToPrint++;
+			pendingCount--;
+		}
+		resultsChanged.notify_all();
+	}
+
+public:
+	BatchSolver(HeuristicType heuristicType, const std::string& patternDirectory, WorkStealingPool& pool, std::ostream& output,
+		size_t maxPending, bool orderMoves = false, size_t transpositionsSize = 0, unsigned weight = WEIGHT_ONE)
+		: heuristicType(heuristicType), patternDirectory(patternDirectory), pool(pool), output(output), maxPending(maxPending ? maxPending : 1),
+		orderMoves(orderMoves), transpositionsSize(transpositionsSize), weight(weight)
+	{ }
+
+	// Returns the number of puzzles read; `columns` = 0 reads square boards
+	size_t run(std::istream& input, size_t columns = 0)
+	{
+		size_t index = 0;
+		while (true)
+		{
+			std::shared_ptr<Puzzle> puzzle = std::make_shared<Puzzle>();
+			if (!puzzle->read(input, columns))
+				break;
+
+			{
+				std::unique_lock<std::mutex> guard(resultsLock);
+				resultsChanged.wait(guard, [this] { return pendingCount < maxPending; });
+				pendingCount++;
+			}
+
+			pool.submit([this, puzzle, index] { finish(index, solve(*puzzle)); });
+			index++;
+		}
+
+		pool.wait();
+		output.flush();
+		return index;
+	}
+};
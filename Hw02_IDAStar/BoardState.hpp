@@ -0,0 +1,350 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "Heuristics.hpp"
+#include "PackedBoard.hpp"
+#include "SearchStats.hpp"
+
+// Moves are named after the direction the tile slides in; a move and its reverse differ only in the lowest bit
+enum MoveCode : uint8_t
+{
+	MOVE_RIGHT = 0,
+	MOVE_LEFT = 1,
+	MOVE_UP = 2,
+	MOVE_DOWN = 3
+};
+
+const unsigned MOVES_COUNT = 4;
+const unsigned NO_MOVE = MOVES_COUNT;
+const char* const MOVE_NAMES[MOVES_COUNT] = { "right", "left", "up", "down" };
+
+/*
+	The cell the empty tile goes to for every cell and move code, or NO_CELL when the move would leave the board.
+	One table per board size, built on first use and shared by every thread.
+*/
+class NeighborTable
+{
+	std::vector<uint8_t> targets;
+
+public:
+	static const uint8_t NO_CELL = 0xFF;
+	static const size_t MAX_ROWS = 8;
+	static const size_t MAX_COLS = 8;
+
+	NeighborTable(size_t rows, size_t cols)
+		: targets(rows * cols * MOVES_COUNT, (uint8_t)NO_CELL)
+	{
+		static const int OFFSETS[MOVES_COUNT][2] = { { 0, -1 }, { 0, 1 }, { 1, 0 }, { -1, 0 } };
+		for (size_t cell = 0; cell < rows * cols; cell++)
+		{
+			for (unsigned move = 0; move < MOVES_COUNT; move++)
+			{
+				size_t row = cell / cols + OFFSETS[move][0];
+				size_t col = cell % cols + OFFSETS[move][1];
+				if (row < rows && col < cols)
+					targets[cell * MOVES_COUNT + move] = (uint8_t)(row * cols + col);
+			}
+		}
+	}
+
+	unsigned getTarget(unsigned emptyCell, unsigned move) const
+	{
+		return targets[emptyCell * MOVES_COUNT + move];
+	}
+
+	static const NeighborTable& get(size_t rows, size_t cols)
+	{
+		static const std::vector<NeighborTable> tables = []
+		{
+			std::vector<NeighborTable> result;
+			for (size_t rows = 0; rows <= MAX_ROWS; rows++)
+			{
+				for (size_t cols = 0; cols <= MAX_COLS; cols++)
+					result.emplace_back(rows, cols);
+			}
+			return result;
+		}();
+		return tables[rows * (MAX_COLS + 1) + cols];
+	}
+};
+
+struct BoardState
+{
+	size_t rows;
+	size_t cols;
+	unsigned emptyTilePos;
+	unsigned emptyTileTarget;
+	PackedBoard board;
+	const NeighborTable* neighbors;
+
+	unsigned pathCost = 0;
+	unsigned heuristicCost = 0;
+	unsigned heuristicWeight = WEIGHT_ONE;  // fixed point, see WEIGHT_SHIFT
+	uint64_t nodesCount = 0;  // states generated by makeMove
+	SearchCounters counters;  // empty unless built with IDA_STATS
+
+	// Tables of the selected heuristic; without them the heuristic is Manhattan distance
+	const HeuristicTables* heuristic;
+
+	// Pattern database: position of every tile and the cost of every group
+	std::vector<unsigned> tilePositions;
+	std::vector<unsigned> patternCosts;
+
+	// Walking distance: the board's states in the vertical and the horizontal table
+	uint32_t verticalState = 0;
+	uint32_t horizontalState = 0;
+
+	BoardState(const std::vector<unsigned>& board,
+		size_t rows,
+		size_t cols,
+		unsigned emptyTilePos,
+		unsigned emptyTileTarget,
+		unsigned pathCost = 0,
+		const HeuristicTables* heuristic = nullptr)
+		: rows(rows), cols(cols), emptyTilePos(emptyTilePos), emptyTileTarget(emptyTileTarget), board(board),
+		neighbors(&NeighborTable::get(rows, cols)), pathCost(pathCost), heuristicWeight(heuristic ? heuristic->weight : WEIGHT_ONE),
+		heuristic(heuristic)
+	{ }
+
+	// Puts the state on another board of the same size and recalculates the heuristic
+	void setBoard(const PackedBoard& packed, unsigned emptyTile, unsigned cost)
+	{
+		board = packed;
+		emptyTilePos = emptyTile;
+		pathCost = cost;
+		calculateHeuristic();
+	}
+
+	HeuristicType getHeuristicType() const
+	{
+		return heuristic ? heuristic->type : HeuristicType::Manhattan;
+	}
+
+	int getManhattanDistance(unsigned index) const
+	{
+		unsigned tileVal = board[index];
+		if (heuristic)
+			return heuristic->manhattanDistances[tileVal * board.size() + index];
+
+		unsigned targetPos = (emptyTileTarget > tileVal - 1) ? tileVal - 1 : tileVal;
+
+		int rowDist = getTileRow(index) - getTileRow(targetPos);
+		int colDist = getTileCol(index) - getTileCol(targetPos);
+		return std::abs(rowDist) + std::abs(colDist);
+	}
+
+	// Fewest tiles to take out of a row (or column) so the tiles that belong to it are in goal order;
+	// each of them has to leave the line and come back, which adds 2 moves to Manhattan distance
+	unsigned getLineConflicts(unsigned line, bool isColumn) const
+	{
+		static const unsigned MAX_LINE = 16;
+		unsigned targets[MAX_LINE];
+		unsigned longest[MAX_LINE];
+		unsigned targetsCount = 0;
+		unsigned longestOrdered = 0;
+
+		for (unsigned i = 0; i < (isColumn ? rows : cols); i++)
+		{
+			unsigned tile = board[isColumn ? getTileIndex(i, line) : getTileIndex(line, i)];
+			if (tile == 0)
+				continue;
+
+			if (isColumn ? heuristic->goalCols[tile] != line : heuristic->goalRows[tile] != line)
+				continue;
+
+			unsigned target = isColumn ? heuristic->goalRows[tile] : heuristic->goalCols[tile];
+			longest[targetsCount] = 1;
+			for (unsigned j = 0; j < targetsCount; j++)
+			{
+				if (targets[j] < target)
+					longest[targetsCount] = std::max(longest[targetsCount], longest[j] + 1);
+			}
+
+			targets[targetsCount] = target;
+			longestOrdered = std::max(longestOrdered, longest[targetsCount]);
+			targetsCount++;
+		}
+
+		return targetsCount - longestOrdered;
+	}
+
+	void calculateHeuristic()
+	{
+		counters.onHeuristic();
+		heuristicCost = 0;
+		switch (getHeuristicType())
+		{
+		case HeuristicType::PatternDatabase:
+			tilePositions.resize(board.size());
+			for (unsigned i = 0; i < board.size(); i++)
+				tilePositions[board[i]] = i;
+
+			patternCosts.resize(heuristic->patternDatabase.getPatternsCount());
+			for (size_t i = 0; i < patternCosts.size(); i++)
+			{
+				patternCosts[i] = heuristic->patternDatabase.getCost(i, tilePositions.data());
+				heuristicCost += patternCosts[i];
+			}
+			return;
+
+		case HeuristicType::WalkingDistance:
+			verticalState = heuristic->verticalDistance->getStateId(board.getCells(), heuristic->goalRows, false);
+			horizontalState = heuristic->horizontalDistance->getStateId(board.getCells(), heuristic->goalCols, true);
+			heuristicCost = heuristic->verticalDistance->getDistance(verticalState)
+				+ heuristic->horizontalDistance->getDistance(horizontalState);
+			return;
+
+		case HeuristicType::LinearConflict:
+			for (unsigned row = 0; row < rows; row++)
+				heuristicCost += 2 * getLineConflicts(row, false);
+			for (unsigned col = 0; col < cols; col++)
+				heuristicCost += 2 * getLineConflicts(col, true);
+			break;
+
+		default:
+			break;
+		}
+
+		for (unsigned i = 0; i < board.size(); i++)
+		{
+			if (board[i] == 0)
+				continue;
+
+			heuristicCost += getManhattanDistance(i);
+		}
+	}
+
+	bool makeMove(unsigned move)
+	{
+		if (!applyMove(move))
+			return false;
+
+		nodesCount++;
+		counters.onGenerated(pathCost);
+		return true;
+	}
+
+	// Makes the move without counting a generated state, for looking at a child the search may visit later
+	bool applyMove(unsigned move)
+	{
+		unsigned nextTileIndex = neighbors->getTarget(emptyTilePos, move);
+		if (nextTileIndex == NeighborTable::NO_CELL)
+			return false;
+
+		moveTile(nextTileIndex, emptyTilePos);
+		emptyTilePos = nextTileIndex;
+		pathCost++;
+		return true;
+	}
+
+	void undoMove(unsigned move)
+	{
+		unsigned prevTileIndex = neighbors->getTarget(emptyTilePos, move ^ 1);
+		moveTile(prevTileIndex, emptyTilePos);
+		emptyTilePos = prevTileIndex;
+		pathCost--;
+	}
+
+	// Slides the tile at `from` into the empty tile at `to` and updates the heuristic from that tile alone
+	void moveTile(unsigned from, unsigned to)
+	{
+		unsigned tile = board[from];
+		bool isVertical = getTileRow(from) != getTileRow(to);
+		counters.onHeuristic();
+
+		switch (getHeuristicType())
+		{
+		case HeuristicType::PatternDatabase:
+		{
+			board.moveTile(from, to);
+			tilePositions[tile] = to;
+
+			unsigned pattern = heuristic->patternDatabase.getPatternOf(tile);
+			unsigned cost = heuristic->patternDatabase.getCost(pattern, tilePositions.data());
+			heuristicCost += cost - patternCosts[pattern];
+			patternCosts[pattern] = cost;
+			return;
+		}
+
+		case HeuristicType::WalkingDistance:
+			board.moveTile(from, to);
+			if (isVertical)
+			{
+				auto direction = getTileRow(from) < getTileRow(to) ? WalkingDistanceTable::EMPTY_UP : WalkingDistanceTable::EMPTY_DOWN;
+				verticalState = heuristic->verticalDistance->move(verticalState, direction, heuristic->goalRows[tile]);
+			}
+			else
+			{
+				auto direction = getTileCol(from) < getTileCol(to) ? WalkingDistanceTable::EMPTY_UP : WalkingDistanceTable::EMPTY_DOWN;
+				horizontalState = heuristic->horizontalDistance->move(horizontalState, direction, heuristic->goalCols[tile]);
+			}
+
+			heuristicCost = heuristic->verticalDistance->getDistance(verticalState)
+				+ heuristic->horizontalDistance->getDistance(horizontalState);
+			return;
+
+		case HeuristicType::LinearConflict:
+		{
+			// A vertical move keeps the order inside the columns and only changes the two rows it joins (and the other way round).
+			// Of those, only the tile's goal line can gain or lose conflicts, since the tile does not count anywhere else.
+			unsigned goalLine = isVertical ? heuristic->goalRows[tile] : heuristic->goalCols[tile];
+			bool isGoalLineTouched = goalLine == (isVertical ? getTileRow(from) : getTileCol(from))
+				|| goalLine == (isVertical ? getTileRow(to) : getTileCol(to));
+
+			int oldConflicts = isGoalLineTouched ? getLineConflicts(goalLine, !isVertical) : 0;
+			int oldDist = getManhattanDistance(from);
+
+			board.moveTile(from, to);
+
+			int newConflicts = isGoalLineTouched ? getLineConflicts(goalLine, !isVertical) : 0;
+			int newDist = getManhattanDistance(to);
+			heuristicCost += newDist - oldDist + 2 * (newConflicts - oldConflicts);
+			return;
+		}
+
+		default:
+			break;
+		}
+
+		int oldDist = getManhattanDistance(from);
+		board.moveTile(from, to);
+		int newDist = getManhattanDistance(to);
+		heuristicCost += newDist - oldDist;
+	}
+
+	// Weighted IDA* scales the heuristic by heuristicWeight, which trades optimality (within that factor) for speed
+	unsigned getTotalCost() const
+	{
+		return pathCost + (heuristicCost * heuristicWeight >> WEIGHT_SHIFT);
+	}
+
+	unsigned getTileRow(unsigned index) const
+	{
+		return index / cols;
+	}
+
+	unsigned getTileCol(unsigned index) const
+	{
+		return index % cols;
+	}
+
+	unsigned getEmptyTileRow() const
+	{
+		return getTileRow(emptyTilePos);
+	}
+
+	unsigned getEmptyTileCol() const
+	{
+		return getTileCol(emptyTilePos);
+	}
+
+	unsigned getTileIndex(unsigned x, unsigned y) const
+	{
+		return x * cols + y;
+	}
+};
@@ -0,0 +1,98 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PatternDatabase.hpp"
+#include "WalkingDistance.hpp"
+
+// Heuristic weights are fixed point with WEIGHT_SHIFT fraction bits, so weighted costs stay integers
+const unsigned WEIGHT_SHIFT = 4;
+const unsigned WEIGHT_ONE = 1 << WEIGHT_SHIFT;
+
+enum class HeuristicType
+{
+	Manhattan,
+	LinearConflict,
+	WalkingDistance,
+	PatternDatabase
+};
+
+inline bool parseHeuristicType(const std::string& name, HeuristicType& type)
+{
+	if (name == "manhattan")
+		type = HeuristicType::Manhattan;
+	else if (name == "linear-conflict")
+		type = HeuristicType::LinearConflict;
+	else if (name == "walking-distance")
+		type = HeuristicType::WalkingDistance;
+	else if (name == "pdb")
+		type = HeuristicType::PatternDatabase;
+	else
+		return false;
+
+	return true;
+}
+
+/*
+	Everything a heuristic needs besides the board, built once per puzzle size and shared by every search state
+*/
+struct HeuristicTables
+{
+	HeuristicType type = HeuristicType::Manhattan;
+	unsigned weight = WEIGHT_ONE;
+	std::vector<unsigned> goalRows;  // goal row and column of every tile
+	std::vector<unsigned> goalCols;
+	std::vector<uint8_t> manhattanDistances;  // [tile * cells + cell]
+
+	AdditivePatternDatabase patternDatabase;
+	std::unique_ptr<WalkingDistanceTable> verticalDistance;
+	std::unique_ptr<WalkingDistanceTable> horizontalDistance;
+
+	bool load(HeuristicType heuristicType, size_t rows, size_t cols, unsigned emptyTileTarget, const std::string& patternDirectory,
+		std::string& error)
+	{
+		type = heuristicType;
+		size_t cellsCount = rows * cols;
+		goalRows.assign(cellsCount, 0);
+		goalCols.assign(cellsCount, 0);
+		manhattanDistances.assign(cellsCount * cellsCount, 0);
+		for (unsigned tile = 1; tile < cellsCount; tile++)
+		{
+			unsigned targetPos = (emptyTileTarget > tile - 1) ? tile - 1 : tile;
+			goalRows[tile] = targetPos / (unsigned)cols;
+			goalCols[tile] = targetPos % (unsigned)cols;
+
+			for (unsigned cell = 0; cell < cellsCount; cell++)
+			{
+				int rowDist = (int)(cell / cols) - (int)goalRows[tile];
+				int colDist = (int)(cell % cols) - (int)goalCols[tile];
+				manhattanDistances[tile * cellsCount + cell] = (uint8_t)(std::abs(rowDist) + std::abs(colDist));
+			}
+		}
+
+		if (type == HeuristicType::WalkingDistance)
+		{
+			if (rows != cols || rows > WalkingDistanceTable::MAX_ROWS)
+			{
+				error = "Walking distance supports square boards up to 4x4";
+				return false;
+			}
+
+			verticalDistance.reset(new WalkingDistanceTable(rows, emptyTileTarget / (unsigned)rows));
+			horizontalDistance.reset(new WalkingDistanceTable(rows, emptyTileTarget % (unsigned)rows));
+		}
+
+		if (type == HeuristicType::PatternDatabase && !patternDatabase.open(rows, cols, emptyTileTarget, patternDirectory))
+		{
+			error = "Cannot open the pattern databases in " + patternDirectory;
+			return false;
+		}
+
+		return true;
+	}
+};
@@ -0,0 +1,119 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "BoardState.hpp"
+#include "SearchStats.hpp"
+#include "TranspositionTable.hpp"
+
+// Optional additions to the plain search; the defaults leave it as it is
+struct IDAStarOptions
+{
+	bool orderMoves = false;  // expand the children with the lowest f-cost first
+	TranspositionTable* transpositions = nullptr;  // skip states reached again in the same iteration with no shorter path
+};
+
+// Fills `order` with the moves sorted by the f-cost of the state they lead to (kept in `costs`, UINT_MAX for the moves
+// that cannot be made). The children are only scored here, so they are counted once the search makes them.
+inline void orderMoves(BoardState& state, unsigned prevMove, unsigned order[MOVES_COUNT], unsigned costs[MOVES_COUNT])
+{
+	for (unsigned move = 0; move < MOVES_COUNT; move++)
+	{
+		costs[move] = UINT_MAX;
+		if (move != (prevMove ^ 1) && state.applyMove(move))
+		{
+			costs[move] = state.getTotalCost();
+			state.undoMove(move);
+		}
+
+		unsigned i = move;
+		for (; i > 0 && costs[order[i - 1]] > costs[move]; i--)
+			order[i] = order[i - 1];
+		order[i] = move;
+	}
+}
+
+// Returns 0 when the goal is reached (the move codes are left in `path`), otherwise the smallest f-cost above the threshold.
+// A raised `cancelled` flag makes every call return at once.
+inline unsigned idaStar(BoardState& state, unsigned threshold, unsigned prevMove, std::vector<uint8_t>& path,
+	const std::atomic<bool>* cancelled = nullptr, const IDAStarOptions& options = IDAStarOptions())
+{
+	if (cancelled && cancelled->load(std::memory_order_relaxed))
+		return UINT_MAX;
+
+	if (state.getTotalCost() > threshold)
+		return state.getTotalCost();
+
+	if (state.heuristicCost == 0)
+		return 0;
+
+	if (options.transpositions && options.transpositions->isDuplicate(state.board, state.pathCost))
+	{
+		state.counters.onPruned();
+		return UINT_MAX;
+	}
+
+	unsigned minSuccThreshold = UINT_MAX;
+	state.counters.onExpanded();
+
+	unsigned order[MOVES_COUNT] = { MOVE_RIGHT, MOVE_LEFT, MOVE_UP, MOVE_DOWN };
+	unsigned costs[MOVES_COUNT];
+	if (options.orderMoves)
+		orderMoves(state, prevMove, order, costs);
+
+	for (unsigned i = 0; i < MOVES_COUNT; i++)
+	{
+		unsigned move = order[i];
+
+		// The children are sorted, so once one is over the threshold so are the rest
+		if (options.orderMoves && costs[move] > threshold)
+		{
+			minSuccThreshold = std::min(minSuccThreshold, costs[move]);
+			break;
+		}
+
+		// Moving the empty tile back where it just came from never helps
+		if (move == (prevMove ^ 1) || !state.makeMove(move))
+		{
+			state.counters.onPruned();
+			continue;
+		}
+		path.push_back((uint8_t)move);
+
+		unsigned nextThreshold = idaStar(state, threshold, move, path, cancelled, options);
+		if (nextThreshold == 0)
+			return 0;
+
+		minSuccThreshold = std::min(minSuccThreshold, nextThreshold);
+
+		path.pop_back();
+		state.undoMove(move);
+	}
+
+	return minSuccThreshold;
+}
+
+// Runs threshold iterations from `root` (with its heuristic calculated) until the goal is reached.
+// `minThreshold` skips the iterations below a known lower bound of the solution length.
+inline bool solveIDAStar(BoardState& root, std::vector<uint8_t>& path, SearchStats& stats, unsigned minThreshold = 0,
+	const IDAStarOptions& options = IDAStarOptions())
+{
+	unsigned threshold = std::max(root.getTotalCost(), minThreshold);
+	while (threshold != 0 && threshold != UINT_MAX)
+	{
+		if (options.transpositions)
+			options.transpositions->setIteration(TranspositionTable::newIteration());
+
+		root.counters = SearchCounters();
+		unsigned nextThreshold = idaStar(root, threshold, NO_MOVE, path, nullptr, options);
+		stats.addIteration(threshold, root.counters);
+		threshold = nextThreshold;
+	}
+
+	return threshold == 0;
+}
@@ -1,254 +1,199 @@
 // Ivan Makaveev, 2MI0600203
 #include <iostream>
+#include <fstream>
 #include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
 #include <vector>
 #include <string>
-
-struct BoardState
+#include <thread>
+#include <memory>
+
+#include "BatchSolver.hpp"
+#include "BoardState.hpp"
+#include "Heuristics.hpp"
+#include "IDAStar.hpp"
+#include "MemoryBoundedAStar.hpp"
+#include "ParallelIDAStar.hpp"
+#include "Puzzle.hpp"
+#include "SearchStats.hpp"
+#include "TranspositionTable.hpp"
+#include "WorkStealingPool.hpp"
+
+void printSolution(const std::vector<uint8_t>& pathResult)
 {
-	size_t rows;
-	unsigned emptyTilePos;
-	unsigned emptyTileTarget;
-	std::vector<unsigned>& board;
-
-	unsigned pathCost = 0;
-	unsigned heuristicCost = 0;
-
-	BoardState(std::vector<unsigned>& board,
-		size_t rows,
-		unsigned emptyTilePos,
-		unsigned emptyTileTarget,
-		unsigned pathCost = 0)
-		: board(board), rows(rows), emptyTilePos(emptyTilePos), emptyTileTarget(emptyTileTarget), pathCost(pathCost)
-	{ }
-
-	int getManhattanDistance(unsigned index)
-	{
-		unsigned tileVal = board[index];
-		unsigned targetPos = (emptyTileTarget > tileVal - 1) ? tileVal - 1 : tileVal;
-
-		int rowDist = getTileRow(index) - getTileRow(targetPos);
-		int colDist = getTileCol(index) - getTileCol(targetPos);
-		return std::abs(rowDist) + std::abs(colDist);
-	}
-
-	void calculateHeuristic()
-	{
-		heuristicCost = 0;
-		for (int i = 0; i < board.size(); i++)
-		{
-			if (board[i] == 0)
-				continue;
-
-			heuristicCost += getManhattanDistance(i);
-		}
-	}
-
-	bool makeMove(const std::pair<int, int>& move)
-	{
-		unsigned nextTileRow = getEmptyTileRow() + move.first;
-		unsigned nextTileCol = getEmptyTileCol() + move.second;
-		if (!isValidTile(nextTileRow, nextTileCol))
-			return false;
-
-		unsigned nextTileIndex = getTileIndex(nextTileRow, nextTileCol);
-		unsigned prevDistIndex = emptyTilePos;
-		int oldDist = getManhattanDistance(nextTileIndex);
-
-		std::swap(board[emptyTilePos], board[nextTileIndex]);
-		emptyTilePos = nextTileIndex;
-		pathCost++;
-
-		int newDist = getManhattanDistance(prevDistIndex);
-		heuristicCost += newDist - oldDist;
-		return true;
-	}
-
-	void undoMove(const std::pair<int, int>& move)
-	{
-		unsigned prevTileRow = getEmptyTileRow() - move.first;
-		unsigned prevTileCol = getEmptyTileCol() - move.second;
-
-		unsigned prevTileIndex = getTileIndex(prevTileRow, prevTileCol);
-		unsigned prevDistIndex = emptyTilePos;
-		int newDist = getManhattanDistance(prevTileIndex);
-
-		std::swap(board[emptyTilePos], board[prevTileIndex]);
-		emptyTilePos = prevTileIndex;
-		pathCost--;
-
-		int oldDist = getManhattanDistance(prevDistIndex);
-		heuristicCost += oldDist - newDist;
-	}
+	std::cout << pathResult.size() << std::endl;
+	for (uint8_t move : pathResult)
+		std::cout << MOVE_NAMES[move] << std::endl;
+}
 
-	unsigned getTotalCost() const
-	{
-		return pathCost + heuristicCost;
-	}
+enum class SearchType
+{
+	IDAStar,
+	AStar
+};
 
-	unsigned getTileRow(unsigned index) const
-	{
-		return index / rows;
-	}
+struct SearchOptions
+{
+	SearchType type = SearchType::IDAStar;
+	size_t threadsCount = 1;
+	size_t splitDepth = 0;
+	size_t memoryMegabytes = 1024;
+	bool orderMoves = false;
+	size_t transpositionsSize = 0;
+	unsigned weight = WEIGHT_ONE;
+};
 
-	unsigned getTileCol(unsigned index) const
-	{
-		return index % rows;
-	}
+bool solvePuzzle(const Puzzle& puzzle, const HeuristicTables& heuristic, const SearchOptions& options, std::vector<uint8_t>& result,
+	SearchStats& stats)
+{
+	if (!hasSolution(puzzle.board, puzzle.cols, puzzle.emptyTilePos, puzzle.emptyTileTarget))
+		return false;
 
-	unsigned getEmptyTileRow() const
-	{
-		return getTileRow(emptyTilePos);
-	}
+	BoardState root(puzzle.board, puzzle.rows, puzzle.cols, puzzle.emptyTilePos, puzzle.emptyTileTarget, 0, &heuristic);
+	root.calculateHeuristic();
 
-	unsigned getEmptyTileCol() const
+	if (options.type == SearchType::AStar)
 	{
-		return getTileCol(emptyTilePos);
+		MemoryBoundedAStar search(root, options.memoryMegabytes << 20, options.orderMoves, options.transpositionsSize);
+		bool isSolved = search.search(result);
+		stats = search.getStats();
+		if (search.hasUsedFallback())
+			std::cerr << "A* ran out of memory, finished with IDA*" << std::endl;
+		return isSolved;
 	}
 
-	bool isValidTile(unsigned x, unsigned y) const
+	if (options.threadsCount > 1)
 	{
-		return x < rows&& y < rows;
+		WorkStealingPool pool(options.threadsCount);
+		ParallelIDAStar search(root, pool, options.splitDepth, options.orderMoves, options.transpositionsSize);
+		bool isSolved = search.search(result);
+		stats = search.getStats();
+		return isSolved;
 	}
 
-	unsigned getTileIndex(unsigned x, unsigned y) const
+	IDAStarOptions searchOptions;
+	searchOptions.orderMoves = options.orderMoves;
+	std::unique_ptr<TranspositionTable> transpositions;
+	if (options.transpositionsSize)
 	{
-		return x * rows + y;
+		transpositions.reset(new TranspositionTable(options.transpositionsSize));
+		searchOptions.transpositions = transpositions.get();
 	}
-};
-
-void initBoard(size_t n, std::vector<unsigned>& board, unsigned& emptyTilePos)
-{
-	board.reserve(n + 1);
 
-	unsigned temp;
-	for (unsigned i = 0; i <= n; i++)
-	{
-		std::cin >> temp;
-		board.push_back(temp);
-		if (temp == 0)
-			emptyTilePos = i;
-	}
+	return solveIDAStar(root, result, stats, 0, searchOptions);
 }
 
-unsigned getInversions(const std::vector<unsigned>& board)
+/*
+	Command line:
+		--heuristic <name>         manhattan (default), linear-conflict, walking-distance (up to 4x4) or pdb
+		--pdb-dir <directory>      where pattern databases are mapped from or saved to (default .)
+		--threads <count>          threads for parallel IDA* (default 1 - serial, 0 - all hardware threads)
+		--split-depth <levels>     depth at which parallel IDA* splits the tree (default chosen per iteration)
+		--search <name>            ida (default) or astar - memory-bounded A* that falls back to IDA* when the memory runs out
+		--memory-mb <megabytes>    memory budget of A* (default 1024)
+		--transpositions <entries> size of the IDA* transposition table, per thread, also used by A*'s fallback
+		                           (default 0 - none); every entry takes 16 bytes, cleared before the search starts,
+		                           so 262144 entries cost 4 MB and a few milliseconds even on a trivial puzzle
+		--move-ordering <on|off>   expand the children with the lowest f-cost first, in IDA* and A*'s fallback (default off)
+		--weight <factor>          weighted IDA* (or A*): f = g + factor * h, solutions at most factor times longer than optimal (default 1)
+		--cols <count>             columns of a rectangular board, rows follow from the tile count (default square)
+		--batch <file>             solve every puzzle in the file, one serial search per thread, and print the results in input order
+
+	Built with -DIDA_STATS, the search also prints "# STATS:" lines with the counters of every iteration and their totals.
+*/
+int main(int argc, char** argv)
 {
-	unsigned inversionsCount = 0;
-
-	for (unsigned i = 0; i < board.size() - 1; i++)
-	{
-		if (board[i] == 0)
-			continue;
-
-		for (unsigned j = i + 1; j < board.size(); j++)
+	HeuristicType heuristicType = HeuristicType::Manhattan;
+	std::string patternDirectory = ".";
+	SearchOptions options;
+	std::string batchPath;
+	size_t columns = 0;
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--heuristic" && !parseHeuristicType(argv[++i], heuristicType))
 		{
-			if (board[j] && board[i] > board[j])
-				inversionsCount++;
+			std::cerr << "Unknown heuristic " << argv[i] << std::endl;
+			return 1;
+		}
+		else if (arg == "--pdb-dir")
+			patternDirectory = argv[++i];
+		else if (arg == "--threads")
+			options.threadsCount = std::stoul(argv[++i]);
+		else if (arg == "--split-depth")
+			options.splitDepth = std::stoul(argv[++i]);
+		else if (arg == "--search")
+		{
+			std::string name = argv[++i];
+			if (name != "ida" && name != "astar")
+			{
+				std::cerr << "Unknown search " << name << std::endl;
+				return 1;
+			}
+			options.type = name == "astar" ? SearchType::AStar : SearchType::IDAStar;
+		}
+		else if (arg == "--memory-mb")
+			options.memoryMegabytes = std::stoul(argv[++i]);
+		else if (arg == "--move-ordering")
+			options.orderMoves = std::string(argv[++i]) == "on";
+		else if (arg == "--transpositions")
+			options.transpositionsSize = std::stoul(argv[++i]);
+		else if (arg == "--weight")
+			options.weight = (unsigned)std::lround(std::max(std::stod(argv[++i]), 1.0) * WEIGHT_ONE);
+		else if (arg == "--cols")
+			columns = std::stoul(argv[++i]);
+		else if (arg == "--batch")
+			batchPath = argv[++i];
+	}
+
+	if (options.threadsCount == 0)
+		options.threadsCount = std::thread::hardware_concurrency();
+
+	if (!batchPath.empty())
+	{
+		std::ifstream input(batchPath);
+		if (!input)
+		{
+			std::cerr << "Cannot open " << batchPath << std::endl;
+			return 1;
 		}
-	}
-	return inversionsCount;
-}
-
-bool hasSolution(const std::vector<unsigned>& board, size_t rows, unsigned emptyTilePos)
-{
-	unsigned inversionsCount = getInversions(board);
-
-	if (rows & 1)
-		return !(inversionsCount & 1);
-
-	unsigned emptyTileRowReversed = rows - (emptyTilePos / rows);
-	if (emptyTileRowReversed & 1)
-		return !(inversionsCount & 1);
-
-	return (inversionsCount & 1);
-}
-
-unsigned idaStar(BoardState& state, unsigned threshold, const std::pair<int, int>& prevMove, std::vector<std::string>& path)
-{
-	static const std::vector<std::pair<std::string, std::pair<int, int>>> MOVES
-		= { {"right", {0, -1}}, {"left", {0, 1}}, {"up", {1, 0}}, {"down", {-1, 0}} };
-
-	if (state.getTotalCost() > threshold)
-		return state.getTotalCost();
 
-	if (state.heuristicCost == 0)
+		WorkStealingPool pool(options.threadsCount);
+		BatchSolver solver(heuristicType, patternDirectory, pool, std::cout, options.threadsCount * 4, options.orderMoves,
+			options.transpositionsSize, options.weight);
+		solver.run(input, columns);
 		return 0;
+	}
 
-	unsigned minSuccThreshold = UINT_MAX;
-
-	for (const auto& moveData : MOVES)
+	Puzzle puzzle;
+	if (!puzzle.read(std::cin, columns) || !puzzle.isSupported())
 	{
-		auto& move = moveData.second;
-		if ((prevMove.first == -move.first && prevMove.second == move.second && prevMove.second == 0)
-			|| (prevMove.first == move.first && prevMove.first == 0 && prevMove.second == -move.second))
-			continue;
-
-		if (!state.makeMove(move))
-			continue;
-		path.push_back(moveData.first);
-
-		unsigned nextThreshold = idaStar(state, threshold, move, path);
-		if (nextThreshold == 0)
-			return 0;
-
-		minSuccThreshold = std::min(minSuccThreshold, nextThreshold);
-
-		path.pop_back();
-		state.undoMove(move);
+		std::cerr << "Unsupported board" << std::endl;
+		return 1;
 	}
 
-	return minSuccThreshold;
-}
-
-void printSolution(std::vector<std::string>& pathResult)
-{
-	std::cout << pathResult.size() << std::endl;
-	for (const auto& move : pathResult)
-		std::cout << move << std::endl;
-}
-
-bool solvePuzzle(std::vector<unsigned>& board, size_t rows, unsigned emptyTilePos, unsigned emptyTileTarget, std::vector<std::string>& result)
-{
-	if (!hasSolution(board, rows, emptyTilePos))
-		return false;
-
-	BoardState root(board, rows, emptyTilePos, emptyTileTarget);
-	root.calculateHeuristic();
-
-	int threshold = root.getTotalCost();
-	if (threshold == 0)
-		return true;
-
-	do
+	HeuristicTables heuristic;
+	std::string error;
+	if (!heuristic.load(heuristicType, puzzle.rows, puzzle.cols, puzzle.emptyTileTarget, patternDirectory, error))
 	{
-		threshold = idaStar(root, threshold, { 0, 0 }, result);
-	} while (threshold != 0);
-
-	return true;
-}
-
-int main()
-{
-	size_t n;
-	int emptyTileTarget;
-	std::cin >> n >> emptyTileTarget;
-
-	size_t rows = std::sqrt(n + 1);
-	if (emptyTileTarget == -1)
-		emptyTileTarget = n;
-
-	unsigned emptyTilePos;
-	std::vector<unsigned> board;
-	initBoard(n, board, emptyTilePos);
+		std::cerr << error << std::endl;
+		return 1;
+	}
+	heuristic.weight = options.weight;
 
-	std::vector<std::string> pathResult;
+	std::vector<uint8_t> pathResult;
+	SearchStats stats;
 
 	auto start = std::chrono::high_resolution_clock::now();
-	bool isSolved = solvePuzzle(board, rows, emptyTilePos, emptyTileTarget, pathResult);
+	bool isSolved = solvePuzzle(puzzle, heuristic, options, pathResult, stats);
 	auto end = std::chrono::high_resolution_clock::now();
 
 	std::chrono::duration<double, std::milli> duration = end - start;
 	std::cout << "# TIMES_MS: alg=" << duration.count() << std::endl;
+	stats.print(std::cout, (unsigned)pathResult.size());
 
 	if (!isSolved)
 	{
@@ -0,0 +1,204 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BoardState.hpp"
+#include "IDAStar.hpp"
+#include "PackedBoard.hpp"
+#include "SearchStats.hpp"
+#include "TranspositionTable.hpp"
+
+/*
+	A* over a preallocated node pool, for when remembering states pays more than IDA*'s re-expansions.
+	The open list is one stack per f-cost, so pushing and popping are O(1) and the deepest node of the
+	cheapest bucket goes first. Seen boards are found through an open-addressing table of node indices;
+	a board reached again by a shorter path gets a new node and the old one is marked stale.
+	When the pool is full the search gives up on A* and runs IDA* from the root, starting at the
+	f-cost it had reached, so the iterations below it are not repeated. The A* memory is released first, and the
+	fallback runs with the move ordering and transposition table of a plain IDA* search.
+*/
+class MemoryBoundedAStar
+{
+	static const uint32_t NO_NODE = UINT32_MAX;
+	static const size_t INITIAL_TABLE_SIZE = 1 << 12;
+
+	struct Node
+	{
+		PackedBoard board;
+		uint32_t parent;
+		uint16_t pathCost;
+		uint8_t emptyTilePos;
+		uint8_t move;
+		bool isStale;
+	};
+
+	BoardState state;
+	size_t maxNodes;
+	bool orderMoves;
+	size_t transpositionsSize;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> table;  // node index of every seen board, NO_NODE for empty slots
+	size_t tableMask = 0;
+	std::vector<std::vector<uint32_t>> buckets;  // open nodes by f-cost
+	size_t currentBucket = 0;
+
+	bool usedFallback = false;
+	SearchStats stats;
+
+	uint32_t& findSlot(const PackedBoard& board)
+	{
+		size_t slot = board.hash() & tableMask;
+		while (table[slot] != NO_NODE && nodes[table[slot]].board != board)
+			slot = (slot + 1) & tableMask;
+
+		return table[slot];
+	}
+
+	void push(uint32_t parent, unsigned move, unsigned f)
+	{
+		uint32_t index = (uint32_t)nodes.size();
+		nodes.push_back({ state.board, parent, (uint16_t)state.pathCost, (uint8_t)state.emptyTilePos, (uint8_t)move, false });
+
+		// The table grows with the nodes, so a small search does not pay for the whole budget up front
+		if (2 * nodes.size() > table.size())
+		{
+			table.assign(2 * table.size(), (uint32_t)NO_NODE);
+			tableMask = table.size() - 1;
+			for (uint32_t i = 0; i < index; i++)
+			{
+				if (!nodes[i].isStale)
+					findSlot(nodes[i].board) = i;
+			}
+		}
+		findSlot(state.board) = index;
+
+		// An inconsistent heuristic can give a child a lower f-cost than the bucket being expanded
+		size_t bucket = std::max<size_t>(f, currentBucket);
+		if (bucket >= buckets.size())
+			buckets.resize(bucket + 1);
+		buckets[bucket].push_back(index);
+	}
+
+	bool solveFallback(BoardState& root, std::vector<uint8_t>& path)
+	{
+		usedFallback = true;
+		stats.addIteration((unsigned)currentBucket, state.counters);
+
+		std::vector<Node>().swap(nodes);
+		std::vector<uint32_t>().swap(table);
+		std::vector<std::vector<uint32_t>>().swap(buckets);
+
+		IDAStarOptions options;
+		options.orderMoves = orderMoves;
+		std::unique_ptr<TranspositionTable> transpositions;
+		if (transpositionsSize)
+		{
+			transpositions.reset(new TranspositionTable(transpositionsSize));
+			options.transpositions = transpositions.get();
+		}
+
+		path.clear();
+		return solveIDAStar(root, path, stats, (unsigned)currentBucket, options);
+	}
+
+	void buildPath(uint32_t index, std::vector<uint8_t>& path) const
+	{
+		path.clear();
+		for (; nodes[index].parent != NO_NODE; index = nodes[index].parent)
+			path.push_back(nodes[index].move);
+
+		std::reverse(path.begin(), path.end());
+	}
+
+public:
+	// Every node takes about this many bytes: the node itself, up to four table slots and its open list entry
+	static const size_t BYTES_PER_NODE = sizeof(Node) + 4 * sizeof(uint32_t) + sizeof(uint32_t);
+
+	// The pool and the largest table are reserved, not filled: their pages are only touched as the search gets to
+	// them, and growing never copies into a new buffer, which would take twice the budget for a moment.
+	// The IDA* fallback uses `orderMoves` and a transposition table of `transpositionsSize` entries (0 for none).
+	MemoryBoundedAStar(const BoardState& root, size_t memoryBytes, bool orderMoves = false, size_t transpositionsSize = 0)
+		: state(root), maxNodes(std::max<size_t>(memoryBytes / BYTES_PER_NODE, 1)), orderMoves(orderMoves),
+		transpositionsSize(transpositionsSize)
+	{
+		nodes.reserve(maxNodes);
+
+		size_t tableSize = INITIAL_TABLE_SIZE;
+		while (tableSize < 2 * maxNodes)
+			tableSize *= 2;
+		table.reserve(tableSize);
+	}
+
+	bool hasUsedFallback() const
+	{
+		return usedFallback;
+	}
+
+	// A* is reported as one iteration with the threshold it reached, followed by the fallback's iterations
+	const SearchStats& getStats() const
+	{
+		return stats;
+	}
+
+	bool search(std::vector<uint8_t>& path)
+	{
+		BoardState root = state;
+		table.assign(INITIAL_TABLE_SIZE, (uint32_t)NO_NODE);
+		tableMask = INITIAL_TABLE_SIZE - 1;
+
+		push(NO_NODE, NO_MOVE, state.getTotalCost());
+
+		for (currentBucket = state.getTotalCost(); currentBucket < buckets.size(); currentBucket++)
+		{
+			while (!buckets[currentBucket].empty())
+			{
+				uint32_t index = buckets[currentBucket].back();
+				buckets[currentBucket].pop_back();
+				if (nodes[index].isStale)
+					continue;
+
+				const Node node = nodes[index];
+				state.setBoard(node.board, node.emptyTilePos, node.pathCost);
+				if (state.heuristicCost == 0)
+				{
+					stats.addIteration((unsigned)currentBucket, state.counters);
+					buildPath(index, path);
+					return true;
+				}
+
+				state.counters.onExpanded();
+				for (unsigned move = 0; move < MOVES_COUNT; move++)
+				{
+					if (move == (node.move ^ 1u) || !state.makeMove(move))
+					{
+						state.counters.onPruned();
+						continue;
+					}
+
+					uint32_t seen = findSlot(state.board);
+					bool isBetter = seen == NO_NODE || state.pathCost < nodes[seen].pathCost;
+					if (isBetter && nodes.size() == maxNodes)
+						return solveFallback(root, path);
+
+					if (isBetter)
+					{
+						if (seen != NO_NODE)
+							nodes[seen].isStale = true;
+
+						push(index, move, state.getTotalCost());
+					}
+					state.undoMove(move);
+				}
+			}
+		}
+
+		stats.addIteration((unsigned)currentBucket, state.counters);
+		return false;
+	}
+};
@@ -0,0 +1,116 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+	Board packed into 64-bit words, cell by cell from the lowest bit, with as few bits per tile as its values need:
+	4 up to 16 cells, 5 up to 32 and 6 up to 64 (8x8), where some tiles straddle two words.
+	Sliding a tile into the empty cell (value 0) is two XORs, so no cell is ever cleared or masked.
+	Words past the board stay zero, so boards of any size compare word by word.
+*/
+class PackedBoard
+{
+	static const size_t WORDS_COUNT = 6;
+
+	uint64_t words[WORDS_COUNT] = {};
+	unsigned bitsPerTile = 4;
+	uint64_t tileMask = 0xF;
+	unsigned cellsCount = 0;
+	unsigned wordsCount = 0;
+
+	static unsigned getBitsPerTile(size_t cells)
+	{
+		return cells <= 16 ? 4 : cells <= 32 ? 5 : 6;
+	}
+
+	void toggle(unsigned index, uint64_t value)
+	{
+		unsigned bit = index * bitsPerTile;
+		unsigned shift = bit & 63;
+		words[bit >> 6] ^= value << shift;
+		if (shift + bitsPerTile > 64)
+			words[(bit >> 6) + 1] ^= value >> (64 - shift);
+	}
+
+public:
+	static const size_t MAX_CELLS = 64;
+
+	PackedBoard() = default;
+
+	PackedBoard(const std::vector<unsigned>& cells)
+		: bitsPerTile(getBitsPerTile(cells.size())), tileMask((1ull << bitsPerTile) - 1), cellsCount((unsigned)cells.size()),
+		wordsCount((unsigned)((cells.size() * bitsPerTile + 63) / 64))
+	{
+		for (unsigned i = 0; i < cellsCount; i++)
+			toggle(i, cells[i]);
+	}
+
+	unsigned operator[](unsigned index) const
+	{
+		if (bitsPerTile == 4)
+			return (unsigned)(words[index >> 4] >> ((index & 15) << 2)) & 0xF;
+
+		unsigned bit = index * bitsPerTile;
+		unsigned shift = bit & 63;
+		uint64_t value = words[bit >> 6] >> shift;
+		if (shift + bitsPerTile > 64)
+			value |= words[(bit >> 6) + 1] << (64 - shift);
+
+		return (unsigned)(value & tileMask);
+	}
+
+	// Slides the tile at `from` into the empty cell `to`
+	void moveTile(unsigned from, unsigned to)
+	{
+		uint64_t tile = (*this)[from];
+		if (bitsPerTile == 4)
+		{
+			words[from >> 4] ^= tile << ((from & 15) << 2);
+			words[to >> 4] ^= tile << ((to & 15) << 2);
+			return;
+		}
+
+		toggle(from, tile);
+		toggle(to, tile);
+	}
+
+	size_t size() const
+	{
+		return cellsCount;
+	}
+
+	std::vector<unsigned> getCells() const
+	{
+		std::vector<unsigned> cells(cellsCount);
+		for (unsigned i = 0; i < cellsCount; i++)
+			cells[i] = (*this)[i];
+
+		return cells;
+	}
+
+	bool operator==(const PackedBoard& other) const
+	{
+		for (size_t i = 0; i < WORDS_COUNT; i++)
+		{
+			if (words[i] != other.words[i])
+				return false;
+		}
+		return true;
+	}
+
+	bool operator!=(const PackedBoard& other) const
+	{
+		return !(*this == other);
+	}
+
+	uint64_t hash() const
+	{
+		uint64_t hash = words[0] * 0x9E3779B97F4A7C15ull;
+		for (unsigned i = 1; i < wordsCount; i++)
+			hash ^= words[i] + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+		return hash ^ (hash >> 31);
+	}
+};
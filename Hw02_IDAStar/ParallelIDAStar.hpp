@@ -0,0 +1,200 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "BoardState.hpp"
+#include "Heuristics.hpp"
+#include "IDAStar.hpp"
+#include "SearchStats.hpp"
+#include "TranspositionTable.hpp"
+#include "WorkStealingPool.hpp"
+
+/*
+	IDA* where every threshold iteration is split into subtrees: the tree is expanded serially down to the
+	split depth and every node there becomes a task on a work-stealing pool. Each task replays its moves on
+	its own copy of the board and runs the ordinary idaStar below it. The first task to reach the goal raises
+	a shared flag that stops the rest; otherwise the next threshold is the minimum over all tasks and cut nodes.
+*/
+class ParallelIDAStar
+{
+	// Auto split depth aims for this many subtrees per thread so stealing can even out their sizes
+	static const size_t TASKS_PER_THREAD = 8;
+	static const size_t MAX_SPLIT_DEPTH = 16;
+
+	BoardState root;
+	WorkStealingPool& pool;
+	size_t splitDepth;
+	bool orderMoves;
+	size_t transpositionsSize;
+	uint32_t iteration = 0;
+
+	std::atomic<bool> isFound{ false };
+	std::mutex resultLock;
+	std::vector<uint8_t> path;
+	SearchStats stats;
+
+	// Collects the move sequences of the nodes `levels` deep that are within the threshold.
+	// Returns 0 if the goal lies above that depth (its moves are left in `prefix`), otherwise the smallest f-cost cut off.
+	unsigned expandFrontier(BoardState& state, unsigned threshold, std::vector<uint8_t>& prefix, size_t levels,
+		std::vector<std::vector<uint8_t>>& frontier) const
+	{
+		if (state.getTotalCost() > threshold)
+			return state.getTotalCost();
+
+		if (state.heuristicCost == 0)
+			return 0;
+
+		if (levels == 0)
+		{
+			frontier.push_back(prefix);
+			return UINT_MAX;
+		}
+
+		unsigned minSuccThreshold = UINT_MAX;
+		unsigned prevMove = prefix.empty() ? NO_MOVE : prefix.back();
+		state.counters.onExpanded();
+		for (unsigned move = 0; move < MOVES_COUNT; move++)
+		{
+			if (move == (prevMove ^ 1) || !state.makeMove(move))
+			{
+				state.counters.onPruned();
+				continue;
+			}
+			prefix.push_back((uint8_t)move);
+
+			unsigned nextThreshold = expandFrontier(state, threshold, prefix, levels - 1, frontier);
+			if (nextThreshold == 0)
+				return 0;
+
+			minSuccThreshold = std::min(minSuccThreshold, nextThreshold);
+
+			prefix.pop_back();
+			state.undoMove(move);
+		}
+
+		return minSuccThreshold;
+	}
+
+	void setPath(const std::vector<uint8_t>& prefix, const std::vector<uint8_t>& tail)
+	{
+		std::lock_guard<std::mutex> guard(resultLock);
+		path = prefix;
+		path.insert(path.end(), tail.begin(), tail.end());
+	}
+
+	unsigned searchSubtree(const std::vector<uint8_t>& prefix, unsigned threshold, SearchCounters& counters)
+	{
+		if (isFound.load(std::memory_order_relaxed))
+			return UINT_MAX;
+
+		BoardState state = root;
+		for (uint8_t move : prefix)
+			state.applyMove(move);
+
+		// Every worker thread keeps one table; the subtrees it searches in one iteration share it.
+		// A pool can outlive a search, so the table is built again when a search asks for another size.
+		IDAStarOptions options;
+		options.orderMoves = orderMoves;
+		if (transpositionsSize)
+		{
+			thread_local std::unique_ptr<TranspositionTable> transpositions;
+			thread_local size_t tableSize = 0;
+			if (tableSize != transpositionsSize)
+			{
+				transpositions.reset(new TranspositionTable(transpositionsSize));
+				tableSize = transpositionsSize;
+			}
+
+			transpositions->setIteration(iteration);
+			options.transpositions = transpositions.get();
+		}
+
+		// The prefix was already counted by the frontier expansion
+		state.counters = SearchCounters();
+		std::vector<uint8_t> tail;
+		unsigned nextThreshold = idaStar(state, threshold, prefix.back(), tail, &isFound, options);
+		counters = state.counters;
+		if (nextThreshold == 0 && !isFound.exchange(true))
+			setPath(prefix, tail);
+
+		return nextThreshold;
+	}
+
+	// One threshold iteration; returns 0 when solved, otherwise the next threshold
+	unsigned searchIteration(unsigned threshold)
+	{
+		BoardState state = root;
+		state.counters = SearchCounters();
+		std::vector<std::vector<uint8_t>> frontier;
+		std::vector<uint8_t> prefix;
+		unsigned cutThreshold;
+		size_t levels = splitDepth ? splitDepth : 0;
+		do
+		{
+			if (!splitDepth)
+				levels++;
+
+			frontier.clear();
+			cutThreshold = expandFrontier(state, threshold, prefix, levels, frontier);
+			if (cutThreshold == 0)
+			{
+				stats.addIteration(threshold, state.counters);
+				setPath(prefix, {});
+				return 0;
+			}
+		} while (!splitDepth && frontier.size() < TASKS_PER_THREAD * pool.getThreadsCount() && !frontier.empty() && levels < MAX_SPLIT_DEPTH);
+
+		isFound = false;
+		iteration = TranspositionTable::newIteration();
+		std::vector<unsigned> results(frontier.size(), UINT_MAX);
+		std::vector<SearchCounters> counters(frontier.size());
+		for (size_t i = 0; i < frontier.size(); i++)
+		{
+			pool.submit([this, &frontier, &results, &counters, i, threshold] { results[i] = searchSubtree(frontier[i], threshold, counters[i]); });
+		}
+		pool.wait();
+
+		for (const SearchCounters& taskCounters : counters)
+			state.counters.add(taskCounters);
+		stats.addIteration(threshold, state.counters);
+
+		if (isFound)
+			return 0;
+
+		unsigned nextThreshold = cutThreshold;
+		for (unsigned result : results)
+			nextThreshold = std::min(nextThreshold, result);
+		return nextThreshold;
+	}
+
+public:
+	// `root` must have its heuristic calculated; splitDepth = 0 picks the depth automatically in every iteration.
+	// The subtrees are searched with `orderMoves` and a transposition table of `transpositionsSize` entries per thread (0 for none).
+	ParallelIDAStar(const BoardState& root, WorkStealingPool& pool, size_t splitDepth = 0, bool orderMoves = false,
+		size_t transpositionsSize = 0)
+		: root(root), pool(pool), splitDepth(splitDepth), orderMoves(orderMoves), transpositionsSize(transpositionsSize)
+	{ }
+
+	const SearchStats& getStats() const
+	{
+		return stats;
+	}
+
+	bool search(std::vector<uint8_t>& result)
+	{
+		path.clear();
+		unsigned threshold = root.getTotalCost();
+		while (threshold != 0 && threshold != UINT_MAX)
+			threshold = searchIteration(threshold);
+
+		result = path;
+		return threshold == 0;
+	}
+};
@@ -0,0 +1,462 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+	Read-only memory mapping of a whole file
+*/
+class MappedFile
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int file = -1;
+#endif
+
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile()
+	{
+		close();
+	}
+
+	bool open(const std::string& path)
+	{
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			close();
+			return false;
+		}
+		size = (size_t)fileSize.QuadPart;
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+			data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+		file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat fileStat;
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			close();
+			return false;
+		}
+		size = (size_t)fileStat.st_size;
+
+		void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+		if (view != MAP_FAILED)
+			data = (const uint8_t*)view;
+#endif
+		if (!data)
+		{
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void close()
+	{
+#ifdef _WIN32
+		if (data)
+			UnmapViewOfFile(data);
+		if (mapping)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data)
+			munmap((void*)data, size);
+		if (file >= 0)
+			::close(file);
+		file = -1;
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+	const uint8_t* getData() const
+	{
+		return data;
+	}
+
+	size_t getSize() const
+	{
+		return size;
+	}
+};
+
+/*
+	Pattern database for one group of tiles: the fewest moves of the group's tiles needed to bring
+	them to their goal cells, for every placement of the group. Moves of other tiles are free, so
+	the costs of disjoint groups can be added and the sum is still an admissible heuristic.
+	A placement is indexed by ranking the tiles' cells as a partial permutation (cells!/(cells-k)! entries),
+	with one byte per entry. The table is built by a backward breadth-first search from the goal.
+*/
+class PatternDatabase
+{
+	static const uint32_t FILE_MAGIC = 0x31424450;  // "PDB1"
+	static const uint8_t UNSEEN = 0xFF;
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t rows;
+		uint32_t cols;
+		uint32_t emptyTileTarget;
+		uint32_t tilesCount;
+		uint32_t tiles[15];
+		uint64_t entriesCount;
+	};
+
+	std::vector<unsigned> tiles;
+	size_t rows;
+	size_t cols;
+	size_t cellsCount;
+	unsigned emptyTileTarget;
+	uint64_t entriesCount;
+
+	std::vector<uint8_t> ownedCosts;
+	MappedFile mappedFile;
+	const uint8_t* costs = nullptr;
+
+	// Ranks the cells of the group's tiles: digit i is the tile's cell among the cells not taken by the tiles before it
+	uint64_t rankPositions(const unsigned* positions) const
+	{
+		uint64_t index = 0;
+		for (size_t i = 0; i < tiles.size(); i++)
+		{
+			unsigned digit = positions[i];
+			for (size_t j = 0; j < i; j++)
+				digit -= positions[j] < positions[i];
+
+			index = index * (cellsCount - i) + digit;
+		}
+		return index;
+	}
+
+	void unrankPositions(uint64_t index, unsigned* positions) const
+	{
+		unsigned digits[sizeof(FileHeader::tiles) / sizeof(uint32_t)];
+		for (size_t i = tiles.size(); i-- > 0;)
+		{
+			digits[i] = (unsigned)(index % (cellsCount - i));
+			index /= cellsCount - i;
+		}
+
+		uint64_t occupied = 0;
+		for (size_t i = 0; i < tiles.size(); i++)
+		{
+			unsigned cell = 0;
+			for (unsigned freeCells = digits[i];; cell++)
+			{
+				if (occupied >> cell & 1)
+					continue;
+				if (freeCells-- == 0)
+					break;
+			}
+
+			positions[i] = cell;
+			occupied |= 1ull << cell;
+		}
+	}
+
+	unsigned getGoalPosition(unsigned tile) const
+	{
+		return (emptyTileTarget > tile - 1) ? tile - 1 : tile;
+	}
+
+	bool readFile(const std::string& path)
+	{
+		if (!mappedFile.open(path))
+			return false;
+
+		FileHeader header;
+		if (mappedFile.getSize() < sizeof(header))
+			return false;
+		std::memcpy(&header, mappedFile.getData(), sizeof(header));
+
+		bool isMatching = header.magic == FILE_MAGIC && header.rows == rows && header.cols == cols
+			&& header.emptyTileTarget == emptyTileTarget && header.tilesCount == tiles.size()
+			&& header.entriesCount == entriesCount && mappedFile.getSize() == sizeof(header) + entriesCount;
+		for (size_t i = 0; isMatching && i < tiles.size(); i++)
+			isMatching = header.tiles[i] == tiles[i];
+
+		if (!isMatching)
+		{
+			mappedFile.close();
+			return false;
+		}
+
+		costs = mappedFile.getData() + sizeof(header);
+		return true;
+	}
+
+	bool writeFile(const std::string& path) const
+	{
+		FileHeader header = {};
+		header.magic = FILE_MAGIC;
+		header.rows = (uint32_t)rows;
+		header.cols = (uint32_t)cols;
+		header.emptyTileTarget = emptyTileTarget;
+		header.tilesCount = (uint32_t)tiles.size();
+		for (size_t i = 0; i < tiles.size(); i++)
+			header.tiles[i] = tiles[i];
+		header.entriesCount = entriesCount;
+
+		FILE* file = std::fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+
+		bool isWritten = std::fwrite(&header, sizeof(header), 1, file) == 1
+			&& std::fwrite(ownedCosts.data(), 1, ownedCosts.size(), file) == ownedCosts.size();
+		return std::fclose(file) == 0 && isWritten;
+	}
+
+	/*
+		Breadth-first search over (placement, empty cell) states, layer by layer in the number of group moves.
+		Within a layer the empty tile is flood-filled through the cells not taken by the group (those moves are free),
+		and every group tile next to the filled region gives a state of the next layer.
+	*/
+	void build()
+	{
+		std::vector<std::vector<unsigned>> neighbors(cellsCount);
+		for (unsigned cell = 0; cell < cellsCount; cell++)
+		{
+			unsigned row = cell / cols;
+			unsigned col = cell % cols;
+			if (row > 0)
+				neighbors[cell].push_back(cell - (unsigned)cols);
+			if (row + 1 < rows)
+				neighbors[cell].push_back(cell + (unsigned)cols);
+			if (col > 0)
+				neighbors[cell].push_back(cell - 1);
+			if (col + 1 < cols)
+				neighbors[cell].push_back(cell + 1);
+		}
+
+		uint64_t statesCount = entriesCount * cellsCount;
+		std::vector<uint64_t> visited(statesCount / 64 + 1, 0);
+		std::vector<uint64_t> queued(statesCount / 64 + 1, 0);
+		auto isSet = [](const std::vector<uint64_t>& bits, uint64_t index) { return (bits[index >> 6] >> (index & 63)) & 1; };
+		auto setBit = [](std::vector<uint64_t>& bits, uint64_t index) { bits[index >> 6] |= 1ull << (index & 63); };
+		auto clearBit = [](std::vector<uint64_t>& bits, uint64_t index) { bits[index >> 6] &= ~(1ull << (index & 63)); };
+
+		ownedCosts.assign(entriesCount, (uint8_t)UNSEEN);
+
+		unsigned positions[sizeof(FileHeader::tiles) / sizeof(uint32_t)];
+		for (size_t i = 0; i < tiles.size(); i++)
+			positions[i] = getGoalPosition(tiles[i]);
+
+		std::vector<uint64_t> current = { rankPositions(positions) * cellsCount + emptyTileTarget };
+		std::vector<uint64_t> next;
+		std::vector<unsigned> region;
+		std::vector<int> slotAt(cellsCount, -1);
+
+		for (unsigned cost = 0; !current.empty(); cost++)
+		{
+			for (uint64_t state : current)
+				clearBit(queued, state);
+
+			for (uint64_t state : current)
+			{
+				if (isSet(visited, state))
+					continue;
+
+				uint64_t index = state / cellsCount;
+				unsigned emptyCell = (unsigned)(state % cellsCount);
+				if (ownedCosts[index] == UNSEEN)
+					ownedCosts[index] = (uint8_t)cost;
+
+				unrankPositions(index, positions);
+				for (size_t i = 0; i < tiles.size(); i++)
+					slotAt[positions[i]] = (int)i;
+
+				region.assign(1, emptyCell);
+				setBit(visited, state);
+				for (size_t i = 0; i < region.size(); i++)
+				{
+					for (unsigned neighbor : neighbors[region[i]])
+					{
+						int slot = slotAt[neighbor];
+						if (slot < 0)
+						{
+							uint64_t nextState = index * cellsCount + neighbor;
+							if (!isSet(visited, nextState))
+							{
+								setBit(visited, nextState);
+								region.push_back(neighbor);
+							}
+							continue;
+						}
+
+						// The group tile at `neighbor` slides into the empty cell
+						positions[slot] = region[i];
+						uint64_t nextState = rankPositions(positions) * cellsCount + neighbor;
+						positions[slot] = neighbor;
+
+						if (!isSet(visited, nextState) && !isSet(queued, nextState))
+						{
+							setBit(queued, nextState);
+							next.push_back(nextState);
+						}
+					}
+				}
+
+				for (size_t i = 0; i < tiles.size(); i++)
+					slotAt[positions[i]] = -1;
+			}
+
+			current.swap(next);
+			next.clear();
+		}
+
+		costs = ownedCosts.data();
+	}
+
+public:
+	static const size_t MAX_TILES = sizeof(FileHeader::tiles) / sizeof(uint32_t);
+
+	PatternDatabase(const std::vector<unsigned>& tiles, size_t rows, size_t cols, unsigned emptyTileTarget)
+		: tiles(tiles), rows(rows), cols(cols), cellsCount(rows * cols), emptyTileTarget(emptyTileTarget), entriesCount(1)
+	{
+		for (size_t i = 0; i < tiles.size(); i++)
+			entriesCount *= cellsCount - i;
+	}
+
+	// Maps the database from `path`, or builds it and tries to save it there when the file is missing or stale
+	bool open(const std::string& path)
+	{
+		if (readFile(path))
+			return true;
+
+		// A failed save is not an error - the next run just builds the database again
+		build();
+		writeFile(path);
+		return true;
+	}
+
+	// tilePositions[tile] is the cell of every tile on the board
+	unsigned getCost(const unsigned* tilePositions) const
+	{
+		unsigned positions[MAX_TILES];
+		for (size_t i = 0; i < tiles.size(); i++)
+			positions[i] = tilePositions[tiles[i]];
+
+		return costs[rankPositions(positions)];
+	}
+
+	const std::vector<unsigned>& getTiles() const
+	{
+		return tiles;
+	}
+
+	std::string getFileName() const
+	{
+		std::string name = "pdb-" + std::to_string(rows) + "x" + std::to_string(cols) + "-" + std::to_string(emptyTileTarget);
+		for (size_t i = 0; i < tiles.size(); i++)
+			name += (i ? "_" : "-") + std::to_string(tiles[i]);
+
+		return name + ".bin";
+	}
+};
+
+/*
+	Disjoint groups of tiles with a pattern database each; the heuristic is the sum of the groups' costs.
+	Default partitions: 4-4 for 3x3, 6-6-3 for 4x4, 6-6-6-6 for 5x5; other boards get groups of 4 consecutive tiles
+	up to 36 cells and of 3 beyond that, which keeps every database of an 8x8 board under a million entries.
+	Building the 5x5 databases takes about 1 GB of memory and several minutes, but happens only once per directory.
+*/
+class AdditivePatternDatabase
+{
+	std::vector<std::unique_ptr<PatternDatabase>> patterns;
+	std::vector<unsigned> patternOfTile;
+
+	static std::vector<std::vector<unsigned>> getDefaultPartition(size_t rows, size_t cols)
+	{
+		if (rows == 3 && cols == 3)
+			return { { 1, 2, 3, 4 }, { 5, 6, 7, 8 } };
+		if (rows == 4 && cols == 4)
+			return { { 1, 2, 5, 6, 9, 13 }, { 3, 4, 7, 8, 11, 12 }, { 10, 14, 15 } };
+		if (rows == 5 && cols == 5)
+			return { { 1, 2, 3, 6, 7, 8 }, { 4, 5, 9, 10, 14, 15 }, { 11, 12, 16, 17, 21, 22 }, { 13, 18, 19, 20, 23, 24 } };
+
+		unsigned groupSize = rows * cols <= 36 ? 4 : 3;
+		std::vector<std::vector<unsigned>> partition;
+		for (unsigned tile = 1; tile < rows * cols; tile++)
+		{
+			if ((tile - 1) % groupSize == 0)
+				partition.emplace_back();
+			partition.back().push_back(tile);
+		}
+		return partition;
+	}
+
+public:
+	bool open(size_t rows, size_t cols, unsigned emptyTileTarget, const std::string& directory)
+	{
+		patterns.clear();
+		patternOfTile.assign(rows * cols, 0);
+
+		for (const auto& tiles : getDefaultPartition(rows, cols))
+		{
+			for (unsigned tile : tiles)
+				patternOfTile[tile] = (unsigned)patterns.size();
+
+			patterns.emplace_back(new PatternDatabase(tiles, rows, cols, emptyTileTarget));
+			if (!patterns.back()->open(directory + "/" + patterns.back()->getFileName()))
+				return false;
+		}
+
+		return true;
+	}
+
+	size_t getPatternsCount() const
+	{
+		return patterns.size();
+	}
+
+	unsigned getPatternOf(unsigned tile) const
+	{
+		return patternOfTile[tile];
+	}
+
+	unsigned getCost(size_t pattern, const unsigned* tilePositions) const
+	{
+		return patterns[pattern]->getCost(tilePositions);
+	}
+};
@@ -0,0 +1,86 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cmath>
+#include <istream>
+#include <vector>
+
+#include "BoardState.hpp"
+
+/*
+	One puzzle as it is read from the input: the number of tiles, the goal cell of the empty tile
+	(-1 for the last cell) and the board row by row. Boards are square unless the column count is given.
+*/
+struct Puzzle
+{
+	size_t n = 0;
+	size_t rows = 0;
+	size_t cols = 0;
+	unsigned emptyTileTarget = 0;
+	unsigned emptyTilePos = 0;
+	std::vector<unsigned> board;
+
+	bool read(std::istream& input, size_t columns = 0)
+	{
+		int target;
+		if (!(input >> n >> target))
+			return false;
+
+		cols = columns ? columns : (size_t)std::sqrt(n + 1);
+		rows = (n + 1) / cols;
+		emptyTileTarget = target == -1 ? (unsigned)n : (unsigned)target;
+
+		board.clear();
+		board.reserve(n + 1);
+
+		unsigned temp;
+		for (unsigned i = 0; i <= n && input >> temp; i++)
+		{
+			board.push_back(temp);
+			if (temp == 0)
+				emptyTilePos = i;
+		}
+		return board.size() == n + 1;
+	}
+
+	// The board must fill its rows, be at least 2x2 (tiles in one line cannot pass each other), fit a PackedBoard
+	// and aim for a cell on the board
+	bool isSupported() const
+	{
+		return rows * cols == n + 1 && rows >= 2 && cols >= 2 && rows <= NeighborTable::MAX_ROWS && cols <= NeighborTable::MAX_COLS
+			&& emptyTileTarget <= n;
+	}
+};
+
+inline unsigned getInversions(const std::vector<unsigned>& board)
+{
+	unsigned inversionsCount = 0;
+
+	for (unsigned i = 0; i < board.size() - 1; i++)
+	{
+		if (board[i] == 0)
+			continue;
+
+		for (unsigned j = i + 1; j < board.size(); j++)
+		{
+			if (board[j] && board[i] > board[j])
+				inversionsCount++;
+		}
+	}
+	return inversionsCount;
+}
+
+// The goal has no inversions. A horizontal move never changes them and a vertical one moves a tile past cols - 1 others,
+// so with an odd width their count stays even, and with an even width its parity follows the empty tile's row.
+inline bool hasSolution(const std::vector<unsigned>& board, size_t cols, unsigned emptyTilePos, unsigned emptyTileTarget)
+{
+	unsigned inversionsCount = getInversions(board);
+
+	if (cols & 1)
+		return !(inversionsCount & 1);
+
+	unsigned emptyTileRow = emptyTilePos / (unsigned)cols;
+	unsigned targetRow = emptyTileTarget / (unsigned)cols;
+	unsigned rowDistance = emptyTileRow > targetRow ? emptyTileRow - targetRow : targetRow - emptyTileRow;
+	return !((inversionsCount + rowDistance) & 1);
+}
@@ -0,0 +1,135 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+	Search counters, compiled in only when IDA_STATS is defined (e.g. g++ -DIDA_STATS).
+	Without it both classes are empty and every member is an empty inline function,
+	so the search loops compile to the same code as if they were not there.
+*/
+#ifdef IDA_STATS
+struct SearchCounters
+{
+	uint64_t generated = 0;  // states made by a move
+	uint64_t expanded = 0;  // states within the threshold whose moves were tried
+	uint64_t pruned = 0;  // moves skipped for undoing the previous one or leaving the board
+	uint64_t heuristicEvaluations = 0;  // full calculations and incremental updates
+	unsigned maxDepth = 0;
+
+	void onGenerated(unsigned depth)
+	{
+		generated++;
+		maxDepth = std::max(maxDepth, depth);
+	}
+
+	void onExpanded()
+	{
+		expanded++;
+	}
+
+	void onPruned()
+	{
+		pruned++;
+	}
+
+	void onHeuristic()
+	{
+		heuristicEvaluations++;
+	}
+
+	void add(const SearchCounters& other)
+	{
+		generated += other.generated;
+		expanded += other.expanded;
+		pruned += other.pruned;
+		heuristicEvaluations += other.heuristicEvaluations;
+		maxDepth = std::max(maxDepth, other.maxDepth);
+	}
+
+	void print(std::ostream& output) const
+	{
+		output << " generated=" << generated << " expanded=" << expanded << " pruned=" << pruned
+			<< " heuristic_evals=" << heuristicEvaluations << " max_depth=" << maxDepth;
+	}
+};
+
+/*
+	Counters of every threshold iteration (A* reports its whole search as one), printed as
+	"# STATS:" lines of key=value pairs
+*/
+class SearchStats
+{
+	struct Iteration
+	{
+		unsigned threshold;
+		SearchCounters counters;
+	};
+
+	std::vector<Iteration> iterations;
+
+	// The branching factor b of a uniform tree with as many nodes below the root as the last iteration generated:
+	// generated = b + b^2 + ... + b^depth
+	static double getEffectiveBranchingFactor(uint64_t generated, unsigned depth)
+	{
+		if (depth == 0 || generated == 0)
+			return 0;
+
+		double low = 0, high = (double)generated;
+		for (int step = 0; step < 100; step++)
+		{
+			double middle = (low + high) / 2, sum = 0, power = 1;
+			for (unsigned i = 0; i < depth && sum <= generated; i++)
+			{
+				power *= middle;
+				sum += power;
+			}
+
+			(sum < generated ? low : high) = middle;
+		}
+		return low;
+	}
+
+public:
+	void addIteration(unsigned threshold, const SearchCounters& counters)
+	{
+		iterations.push_back({ threshold, counters });
+	}
+
+	void print(std::ostream& output, unsigned solutionLength) const
+	{
+		SearchCounters total;
+		for (size_t i = 0; i < iterations.size(); i++)
+		{
+			output << "# STATS: iteration=" << i + 1 << " threshold=" << iterations[i].threshold;
+			iterations[i].counters.print(output);
+			output << '\n';
+			total.add(iterations[i].counters);
+		}
+
+		uint64_t lastGenerated = iterations.empty() ? 0 : iterations.back().counters.generated;
+		output << "# STATS: total iterations=" << iterations.size();
+		total.print(output);
+		output << " ebf=" << getEffectiveBranchingFactor(lastGenerated, solutionLength) << '\n';
+	}
+};
+#else
+struct SearchCounters
+{
+	void onGenerated(unsigned) { }
+	void onExpanded() { }
+	void onPruned() { }
+	void onHeuristic() { }
+	void add(const SearchCounters&) { }
+};
+
+class SearchStats
+{
+public:
+	void addIteration(unsigned, const SearchCounters&) { }
+	void print(std::ostream&, unsigned) const { }
+};
+#endif
@@ -0,0 +1,78 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "PackedBoard.hpp"
+
+/*
+	Fixed-size table of the smallest path cost every recently seen board was reached with, one entry per slot.
+	Entries are tagged with the search iteration that wrote them and only trusted within it: a state reached again
+	in the same iteration with no shorter path has its subtree searched already with at least as much budget left,
+	which holds for any admissible heuristic. Boards are told apart by their 64-bit hash alone.
+*/
+class TranspositionTable
+{
+	struct Entry
+	{
+		uint64_t key = 0;
+		uint32_t iteration = 0;
+		uint32_t pathCost = 0;
+	};
+
+	std::vector<Entry> entries;
+	size_t mask;
+	uint32_t iteration = 0;
+
+public:
+	static const size_t DEFAULT_SIZE = 1 << 18;
+
+	// `size` is rounded up to a power of two
+	TranspositionTable(size_t size = DEFAULT_SIZE)
+	{
+		size_t entriesCount = 1;
+		while (entriesCount < size)
+			entriesCount <<= 1;
+
+		entries.resize(entriesCount);
+		mask = entriesCount - 1;
+	}
+
+	// Iteration ids come from one counter, so tables reused by other searches (or threads) never mix up their iterations
+	static uint32_t newIteration()
+	{
+		static std::atomic<uint32_t> lastIteration{ 0 };
+		return ++lastIteration;
+	}
+
+	void setIteration(uint32_t id)
+	{
+		iteration = id;
+	}
+
+	// Returns true if the board was reached with no greater cost in this iteration, otherwise records the cost
+	bool isDuplicate(const PackedBoard& board, unsigned pathCost)
+	{
+		uint64_t key = board.hash();
+		Entry& entry = entries[key & mask];
+		if (entry.iteration == iteration)
+		{
+			if (entry.key == key)
+			{
+				if (entry.pathCost <= pathCost)
+					return true;
+			}
+			// Keep the shallower of two colliding boards; its subtree is the larger one
+			else if (entry.pathCost < pathCost)
+				return false;
+		}
+
+		entry.key = key;
+		entry.iteration = iteration;
+		entry.pathCost = pathCost;
+		return false;
+	}
+};
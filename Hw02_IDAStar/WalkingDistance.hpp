@@ -0,0 +1,151 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*
+	Walking distance table for one direction (vertical or horizontal). A state only records, for every row,
+	how many tiles of each goal row it holds and which row has the empty tile; the table is the fewest
+	vertical moves that sort every tile into its goal row. Summing the vertical and the horizontal tables
+	(the latter built over columns) gives an admissible heuristic that dominates Manhattan distance.
+	States get ids in breadth-first order and the moves between them are precomputed,
+	so a board keeps its state id and every move is a single table lookup.
+	The 4x4 table has 24964 states; the 5x5 one does not fit in memory, so the heuristic stops at 4x4.
+*/
+class WalkingDistanceTable
+{
+	static const unsigned COUNT_BITS = 3;
+	static const uint32_t NO_STATE = UINT32_MAX;
+
+	size_t rows;
+	std::unordered_map<uint64_t, uint32_t> stateIds;
+	std::vector<uint8_t> distances;
+	std::vector<uint32_t> transitions;  // [state][direction][goal line of the moved tile]
+
+	// The count in the last column is implied by the line's size and is left out of the code
+	uint64_t encode(const std::vector<unsigned>& counts, unsigned emptyLine) const
+	{
+		uint64_t code = emptyLine;
+		for (size_t line = 0; line < rows; line++)
+		{
+			for (size_t goalLine = 0; goalLine + 1 < rows; goalLine++)
+				code = code << COUNT_BITS | counts[line * rows + goalLine];
+		}
+		return code;
+	}
+
+	unsigned decode(uint64_t code, std::vector<unsigned>& counts) const
+	{
+		for (size_t line = rows; line-- > 0;)
+		{
+			unsigned lineSize = (unsigned)rows;
+			for (size_t goalLine = rows - 1; goalLine-- > 0;)
+			{
+				counts[line * rows + goalLine] = code & ((1u << COUNT_BITS) - 1);
+				lineSize -= counts[line * rows + goalLine];
+				code >>= COUNT_BITS;
+			}
+			counts[line * rows + rows - 1] = lineSize;
+		}
+
+		unsigned emptyLine = (unsigned)code;
+		counts[emptyLine * rows + rows - 1]--;
+		return emptyLine;
+	}
+
+	uint32_t addState(const std::vector<unsigned>& counts, unsigned emptyLine, std::vector<uint64_t>& codes, uint8_t distance)
+	{
+		uint64_t code = encode(counts, emptyLine);
+		auto inserted = stateIds.emplace(code, (uint32_t)codes.size());
+		if (inserted.second)
+		{
+			codes.push_back(code);
+			distances.push_back(distance);
+		}
+		return inserted.first->second;
+	}
+
+public:
+	static const size_t MAX_ROWS = 4;
+
+	enum Direction
+	{
+		EMPTY_UP = 0,
+		EMPTY_DOWN = 1
+	};
+
+	// goalEmptyLine is the row (or column) of the empty tile in the goal
+	WalkingDistanceTable(size_t rows, unsigned goalEmptyLine)
+		: rows(rows)
+	{
+		std::vector<uint64_t> codes;
+		std::vector<unsigned> counts(rows * rows, 0);
+		for (size_t line = 0; line < rows; line++)
+			counts[line * rows + line] = (unsigned)rows - (line == goalEmptyLine);
+		addState(counts, goalEmptyLine, codes, 0);
+
+		for (uint32_t id = 0; id < codes.size(); id++)
+		{
+			transitions.resize((id + 1) * 2 * rows, (uint32_t)NO_STATE);
+			unsigned emptyLine = decode(codes[id], counts);
+
+			for (unsigned direction = EMPTY_UP; direction <= EMPTY_DOWN; direction++)
+			{
+				if ((direction == EMPTY_UP && emptyLine == 0) || (direction == EMPTY_DOWN && emptyLine + 1 == rows))
+					continue;
+
+				unsigned nextEmptyLine = direction == EMPTY_UP ? emptyLine - 1 : emptyLine + 1;
+				for (size_t goalLine = 0; goalLine < rows; goalLine++)
+				{
+					if (counts[nextEmptyLine * rows + goalLine] == 0)
+						continue;
+
+					// A tile of goalLine slides from the empty tile's new line into its old one
+					counts[nextEmptyLine * rows + goalLine]--;
+					counts[emptyLine * rows + goalLine]++;
+
+					uint32_t nextId = addState(counts, nextEmptyLine, codes, distances[id] + 1);
+					transitions[(id * 2 + direction) * rows + goalLine] = nextId;
+
+					counts[nextEmptyLine * rows + goalLine]++;
+					counts[emptyLine * rows + goalLine]--;
+				}
+			}
+		}
+	}
+
+	// goalLines[tile] is the goal row of every tile, or its goal column when `transposed`
+	uint32_t getStateId(const std::vector<unsigned>& board, const std::vector<unsigned>& goalLines, bool transposed) const
+	{
+		std::vector<unsigned> counts(rows * rows, 0);
+		unsigned emptyLine = 0;
+		for (size_t i = 0; i < board.size(); i++)
+		{
+			size_t line = transposed ? i % rows : i / rows;
+			if (board[i] == 0)
+				emptyLine = (unsigned)line;
+			else
+				counts[line * rows + goalLines[board[i]]]++;
+		}
+
+		return stateIds.at(encode(counts, emptyLine));
+	}
+
+	uint32_t move(uint32_t stateId, Direction direction, unsigned goalLine) const
+	{
+		return transitions[(stateId * 2 + direction) * rows + goalLine];
+	}
+
+	unsigned getDistance(uint32_t stateId) const
+	{
+		return distances[stateId];
+	}
+
+	size_t getStatesCount() const
+	{
+		return distances.size();
+	}
+};
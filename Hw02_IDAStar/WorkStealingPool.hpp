@@ -0,0 +1,149 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+	Fixed-size thread pool where every worker has its own task queue.
+	A worker takes tasks from the front of its own queue, in the order they were submitted, and when it
+	runs dry steals from the back of the other queues - so uneven subtrees even out on their own.
+	Hw01_DFS and Hw02_IDAStar each keep a copy so that every homework builds from its own directory;
+	a fix to one copy belongs in the other as well.
+*/
+class WorkStealingPool
+{
+	struct WorkerQueue
+	{
+		std::mutex lock;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex stateLock;
+	std::condition_variable stateChanged;
+	size_t pendingTasks = 0;
+	std::atomic<size_t> queuedTasks{ 0 };
+	size_t nextQueue = 0;
+	bool isStopping = false;
+
+	bool popOwn(size_t worker, std::function<void()>& task)
+	{
+		WorkerQueue& queue = *queues[worker];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (queue.tasks.empty())
+			return false;
+
+		task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+		return true;
+	}
+
+	bool steal(size_t worker, std::function<void()>& task)
+	{
+		for (size_t i = 1; i < queues.size(); i++)
+		{
+			WorkerQueue& queue = *queues[(worker + i) % queues.size()];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (queue.tasks.empty())
+				continue;
+
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			return true;
+		}
+
+		return false;
+	}
+
+	void run(size_t worker)
+	{
+		std::function<void()> task;
+		while (true)
+		{
+			if (popOwn(worker, task) || steal(worker, task))
+			{
+				queuedTasks--;
+				task();
+				task = nullptr;
+
+				std::lock_guard<std::mutex> guard(stateLock);
+				if (--pendingTasks == 0)
+					stateChanged.notify_all();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> guard(stateLock);
+			stateChanged.wait(guard, [this] { return isStopping || queuedTasks > 0; });
+			if (isStopping && queuedTasks == 0)
+				return;
+		}
+	}
+
+public:
+	WorkStealingPool(size_t threadsCount)
+	{
+		if (threadsCount == 0)
+			threadsCount = 1;
+
+		for (size_t i = 0; i < threadsCount; i++)
+			queues.push_back(std::make_unique<WorkerQueue>());
+
+		for (size_t i = 0; i < threadsCount; i++)
+			workers.emplace_back(&WorkStealingPool::run, this, i);
+	}
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	~WorkStealingPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(stateLock);
+			isStopping = true;
+		}
+		stateChanged.notify_all();
+
+		for (auto& worker : workers)
+			worker.join();
+	}
+
+	// Tasks are dealt to the worker queues in turn
+	void submit(std::function<void()> task)
+	{
+		size_t target;
+		{
+			std::lock_guard<std::mutex> guard(stateLock);
+			pendingTasks++;
+			queuedTasks++;
+			target = nextQueue;
+			nextQueue = (nextQueue + 1) % queues.size();
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(queues[target]->lock);
+			queues[target]->tasks.push_back(std::move(task));
+		}
+		stateChanged.notify_all();
+	}
+
+	// Blocks until every submitted task has finished
+	void wait()
+	{
+		std::unique_lock<std::mutex> guard(stateLock);
+		stateChanged.wait(guard, [this] { return pendingTasks == 0; });
+	}
+
+	size_t getThreadsCount() const
+	{
+		return workers.size();
+	}
+};
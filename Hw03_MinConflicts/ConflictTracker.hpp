@@ -0,0 +1,80 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RandomEngine.hpp"
+
+/*
+	The variables whose value violates a constraint, in no particular order, and the number of violated constraints.
+	Models update it with every assignment, so no step of the search scans the variables. Every listed variable keeps
+	its position in the list, so a freed one is swapped out at once and a random pick is uniform over the conflicted ones.
+*/
+class ConflictTracker
+{
+	static const unsigned NOT_LISTED = UINT32_MAX;
+
+	std::vector<unsigned> conflictedVars;
+	std::vector<unsigned> positions;  // index of every variable in conflictedVars, NOT_LISTED while it has no conflicts
+	uint64_t conflictsCount = 0;
+
+public:
+	explicit ConflictTracker(size_t variablesCount)
+		: positions(variablesCount, (unsigned)NOT_LISTED)
+	{ }
+
+	void mark(unsigned var)
+	{
+		if (positions[var] != NOT_LISTED)
+			return;
+
+		positions[var] = (unsigned)conflictedVars.size();
+		conflictedVars.push_back(var);
+	}
+
+	// Moves the last listed variable into the freed slot
+	void unmark(unsigned var)
+	{
+		unsigned position = positions[var];
+		if (position == NOT_LISTED)
+			return;
+
+		unsigned lastVar = conflictedVars.back();
+		conflictedVars[position] = lastVar;
+		positions[lastVar] = position;
+		conflictedVars.pop_back();
+		positions[var] = NOT_LISTED;
+	}
+
+	void addConflicts(uint64_t count)
+	{
+		conflictsCount += count;
+	}
+
+	void removeConflicts(uint64_t count)
+	{
+		conflictsCount -= count;
+	}
+
+	bool hasConflicts() const
+	{
+		return conflictsCount != 0;
+	}
+
+	// A random conflicted variable; there must be one
+	unsigned getRandomConflicted(RandomEngine& randomEngine) const
+	{
+		return conflictedVars[randomEngine.nextBelow((uint32_t)conflictedVars.size())];
+	}
+
+	void clear()
+	{
+		for (unsigned var : conflictedVars)
+			positions[var] = NOT_LISTED;
+
+		conflictedVars.clear();
+		conflictsCount = 0;
+	}
+};
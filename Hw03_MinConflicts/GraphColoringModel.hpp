@@ -0,0 +1,236 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <utility>
+#include <vector>
+
+#include "ConflictTracker.hpp"
+#include "RandomEngine.hpp"
+
+/*
+	Graph coloring for MinConflictsEngine: every vertex is a variable, every color a value, and every edge whose ends
+	share a color a violated constraint. Each vertex keeps how many of its neighbors have every color, so the conflicts
+	of any color are one lookup and recoloring a vertex touches only the counters of its neighbors.
+	Min-conflicts is incomplete, so a graph that needs more colors keeps the search going until it runs out of restarts;
+	only the cheap cases - a self-loop, an edge with one color, an odd cycle with two - are turned down up front,
+	and a bipartite graph with two colors is colored by its sides without searching.
+*/
+class GraphColoringModel
+{
+	static const unsigned NOT_ASSIGNED = UINT_MAX;
+
+	unsigned colorsCount;
+	std::vector<size_t> firstNeighbor;  // the neighbors of vertex v are neighbors[firstNeighbor[v]] up to firstNeighbor[v + 1]
+	std::vector<unsigned> neighbors;
+	std::vector<unsigned> colors;
+	std::vector<unsigned> neighborColors;  // at vertex * colorsCount + color, the neighbors of the vertex with that color
+	bool hasSelfLoop = false;
+
+	unsigned& getNeighborColors(unsigned vertex, unsigned color)
+	{
+		return neighborColors[(size_t)vertex * colorsCount + color];
+	}
+
+	// Two-colors every component breadth-first into `sides`; false when a neighbor on the same side closes a cycle
+	// of odd length, so no two-coloring exists
+	bool findTwoColoring(std::vector<uint8_t>& sides) const
+	{
+		static const uint8_t NOT_REACHED = 2;
+
+		sides.assign(colors.size(), NOT_REACHED);
+		std::vector<unsigned> queue;
+		for (unsigned start = 0; start < colors.size(); start++)
+		{
+			if (sides[start] != NOT_REACHED)
+				continue;
+
+			sides[start] = 0;
+			queue.assign(1, start);
+			for (size_t next = 0; next < queue.size(); next++)
+			{
+				unsigned vertex = queue[next];
+				for (size_t i = firstNeighbor[vertex]; i < firstNeighbor[vertex + 1]; i++)
+				{
+					unsigned neighbor = neighbors[i];
+					if (sides[neighbor] == sides[vertex])
+						return false;
+
+					if (sides[neighbor] == NOT_REACHED)
+					{
+						sides[neighbor] = sides[vertex] ^ 1;
+						queue.push_back(neighbor);
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+public:
+	GraphColoringModel(size_t verticesCount, const std::vector<std::pair<unsigned, unsigned>>& edges, unsigned colorsCount)
+		: colorsCount(colorsCount), firstNeighbor(verticesCount + 1, 0), neighbors(2 * edges.size()),
+		colors(verticesCount, (unsigned)NOT_ASSIGNED), neighborColors(verticesCount * colorsCount, 0)
+	{
+		for (const auto& edge : edges)
+		{
+			firstNeighbor[edge.first + 1]++;
+			firstNeighbor[edge.second + 1]++;
+			hasSelfLoop |= edge.first == edge.second;
+		}
+
+		for (size_t vertex = 0; vertex < verticesCount; vertex++)
+			firstNeighbor[vertex + 1] += firstNeighbor[vertex];
+
+		std::vector<size_t> nextNeighbor(firstNeighbor.begin(), firstNeighbor.end() - 1);
+		for (const auto& edge : edges)
+		{
+			neighbors[nextNeighbor[edge.first]++] = edge.second;
+			neighbors[nextNeighbor[edge.second]++] = edge.first;
+		}
+	}
+
+	// Reads "vertices edges colors" followed by the edges as pairs of 0-based vertices.
+	// Returns false on malformed input or a vertex out of range.
+	static bool read(std::istream& input, size_t& verticesCount, std::vector<std::pair<unsigned, unsigned>>& edges,
+		unsigned& colorsCount)
+	{
+		size_t edgesCount;
+		if (!(input >> verticesCount >> edgesCount >> colorsCount))
+			return false;
+
+		edges.resize(edgesCount);
+		for (auto& edge : edges)
+		{
+			if (!(input >> edge.first >> edge.second) || edge.first >= verticesCount || edge.second >= verticesCount)
+				return false;
+		}
+
+		return true;
+	}
+
+	size_t getVariablesCount() const
+	{
+		return colors.size();
+	}
+
+	unsigned getValuesCount() const
+	{
+		return colorsCount;
+	}
+
+	unsigned getValue(unsigned vertex) const
+	{
+		return colors[vertex];
+	}
+
+	unsigned getConflictsCount(unsigned vertex, unsigned color)
+	{
+		return getNeighborColors(vertex, color);
+	}
+
+	unsigned getCurrentConflictsCount(unsigned vertex)
+	{
+		return getNeighborColors(vertex, colors[vertex]);
+	}
+
+	void assign(unsigned vertex, unsigned color, ConflictTracker& conflicts)
+	{
+		colors[vertex] = color;
+		for (size_t i = firstNeighbor[vertex]; i < firstNeighbor[vertex + 1]; i++)
+		{
+			unsigned neighbor = neighbors[i];
+			getNeighborColors(neighbor, color)++;
+			if (colors[neighbor] == color)
+			{
+				conflicts.addConflicts(1);
+				conflicts.mark(neighbor);
+			}
+		}
+
+		if (getNeighborColors(vertex, color) != 0)
+			conflicts.mark(vertex);
+	}
+
+	void unassign(unsigned vertex, ConflictTracker& conflicts)
+	{
+		unsigned color = colors[vertex];
+		colors[vertex] = NOT_ASSIGNED;
+		for (size_t i = firstNeighbor[vertex]; i < firstNeighbor[vertex + 1]; i++)
+		{
+			unsigned neighbor = neighbors[i];
+			getNeighborColors(neighbor, color)--;
+			if (colors[neighbor] == color)
+			{
+				conflicts.removeConflicts(1);
+				if (getNeighborColors(neighbor, color) == 0)
+					conflicts.unmark(neighbor);
+			}
+		}
+
+		conflicts.unmark(vertex);
+	}
+
+	void clear()
+	{
+		std::fill(colors.begin(), colors.end(), (unsigned)NOT_ASSIGNED);
+		std::fill(neighborColors.begin(), neighborColors.end(), 0);
+	}
+
+	bool isUnsolvable() const
+	{
+		if (hasSelfLoop || (colorsCount == 0 && !colors.empty()))
+			return true;
+
+		std::vector<uint8_t> sides;
+		return (colorsCount == 1 && !neighbors.empty()) || (colorsCount == 2 && !findTwoColoring(sides));
+	}
+
+	// Two colors are solved outright by the sides of a bipartite graph. Otherwise placing every vertex on its least
+	// conflicted color is already a greedy coloring, so there is nothing faster.
+	bool initializeFast(RandomEngine&, ConflictTracker& conflicts)
+	{
+		std::vector<uint8_t> sides;
+		if (colorsCount != 2 || !findTwoColoring(sides))
+			return false;
+
+		for (unsigned vertex = 0; vertex < colors.size(); vertex++)
+			assign(vertex, sides[vertex], conflicts);
+
+		return true;
+	}
+
+	void beginGreedyInitialization()
+	{ }
+
+	void endGreedyInitialization()
+	{ }
+
+	// Every color is examined when there are few, and when there are many none stands out
+	template <typename Visitor>
+	void forEachPromisingValue(unsigned, size_t, RandomEngine&, Visitor)
+	{ }
+
+	// Checks every edge against the colors alone
+	bool verify()
+	{
+		for (unsigned vertex = 0; vertex < colors.size(); vertex++)
+		{
+			if (colors[vertex] >= colorsCount)
+				return false;
+
+			for (size_t i = firstNeighbor[vertex]; i < firstNeighbor[vertex + 1]; i++)
+			{
+				if (colors[neighbors[i]] == colors[vertex])
+					return false;
+			}
+		}
+
+		return true;
+	}
+};
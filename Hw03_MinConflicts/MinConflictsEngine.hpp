@@ -0,0 +1,310 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "ConflictTracker.hpp"
+#include "RandomEngine.hpp"
+
+// How a run searches and when it gives up on an assignment; the defaults keep the plain min-conflicts walk
+struct SolverOptions
+{
+	bool fastInit = true;  // the model's own placement when it has one, instead of every variable on its least conflicted value
+	size_t sampleSize = 100;  // values examined per move, 0 for all of them
+	uint64_t seed = 0;
+	uint64_t maxSteps = 0;  // moves before starting over from a new assignment, 0 for no limit
+	bool autoMaxSteps = false;  // maxSteps follows from the number of variables instead
+	uint64_t maxRestarts = 0;  // restarts before giving up, 0 for no limit
+	size_t tabuTenure = 0;  // how many of the last moved variables are not picked again
+	double randomWalkProbability = 0;  // chance that a move goes to a random value instead of the best one
+};
+
+// Counters of one run, printed as a "# STATS:" line of key=value pairs
+struct SolverStats
+{
+	uint64_t steps = 0;
+	uint64_t restarts = 0;
+	uint64_t sidewaysMoves = 0;  // moves that left the variable with no fewer conflicts
+	uint64_t randomWalks = 0;
+	uint64_t tabuSkips = 0;  // picked variables passed over for being moved recently
+
+	void add(const SolverStats& other)
+	{
+		steps += other.steps;
+		restarts += other.restarts;
+		sidewaysMoves += other.sidewaysMoves;
+		randomWalks += other.randomWalks;
+		tabuSkips += other.tabuSkips;
+	}
+
+	void print(std::ostream& output) const
+	{
+		output << "# STATS: steps=" << steps << " restarts=" << restarts << " sideways=" << sidewaysMoves
+			<< " random_walks=" << randomWalks << " tabu_skips=" << tabuSkips << '\n';
+	}
+};
+
+/*
+	Min-conflicts local search over a constraint model: start from a full assignment, then keep moving a random
+	conflicted variable to the value with the fewest conflicts until none are left. The model owns the assignment and
+	keeps its conflict counters up to date, reporting the changes to a ConflictTracker, so a step costs only the values
+	it examines. A model provides:
+
+		size_t getVariablesCount(), unsigned getValuesCount()
+		unsigned getValue(var)                          the value of an assigned variable
+		unsigned getConflictsCount(var, value)          conflicts the variable would have with another value
+		unsigned getCurrentConflictsCount(var)          conflicts it has with its value
+		void assign(var, value, ConflictTracker&)       gives an unassigned variable a value
+		void unassign(var, ConflictTracker&)
+		void clear()                                    unassigns every variable
+		bool initializeFast(RandomEngine&, ConflictTracker&)    assigns every variable in its own way, false if it has none
+		void beginGreedyInitialization(), void endGreedyInitialization()    around placing the variables one by one
+		void forEachPromisingValue(var, limit, RandomEngine&, visit)    up to `limit` values likely to have few conflicts,
+		                                                                examined on top of the random sample
+		bool isUnsolvable()                             known to have no solution without searching
+*/
+template <typename Model>
+class MinConflictsEngine
+{
+	static const unsigned NOT_FOUND = UINT_MAX;
+	// Tabu variables are looked for in a short list, so a variable that keeps being drawn gives up after this many draws
+	static const unsigned TABU_ATTEMPTS = 8;
+	static const uint64_t AUTO_STEPS_PER_VARIABLE = 20;
+
+	Model model;
+	SolverOptions options;
+	SolverStats stats;
+	ConflictTracker conflicts;
+	RandomEngine randomEngine;
+	bool isInitialized = false;
+	bool isGivenUp = false;  // the restarts ran out, which says nothing about whether a solution exists
+
+	std::vector<unsigned> valueCandidates;  // reused by every value search
+
+	// The last `tabuTenure` moved variables as a ring, NOT_FOUND where no variable was moved yet
+	std::vector<unsigned> tabuVars;
+	size_t tabuNext = 0;
+
+	unsigned getRandomIndexFromBehind(size_t collectionSize, size_t elementsCount)
+	{
+		return (collectionSize - 1) - randomEngine.nextBelow((uint32_t)elementsCount);
+	}
+
+	// Keeps the values with the fewest conflicts seen so far at the back of valueCandidates
+	void addValueCandidate(unsigned value, unsigned conflictsCount, unsigned& minConflicts, size_t& candidatesCount)
+	{
+		if (minConflicts >= conflictsCount)
+		{
+			if (minConflicts > conflictsCount)
+			{
+				candidatesCount = 0;
+				minConflicts = conflictsCount;
+			}
+
+			candidatesCount++;
+			valueCandidates.push_back(value);
+		}
+	}
+
+	// Examines `sampleSize` random values and as many of the model's promising ones instead of all of them. Returns
+	// NOT_FOUND when every sampled value is worse than the current one, so a full scan can look for a better one.
+	unsigned getSampledMinConflictsValue(unsigned var)
+	{
+		unsigned minConflicts = INT_MAX;
+		size_t candidatesCount = 0;
+		valueCandidates.clear();
+
+		model.forEachPromisingValue(var, options.sampleSize, randomEngine, [&](unsigned value)
+		{
+			addValueCandidate(value, model.getConflictsCount(var, value), minConflicts, candidatesCount);
+		});
+
+		unsigned currentValue = isInitialized ? model.getValue(var) : NOT_FOUND;
+		for (size_t i = 0; i < options.sampleSize; i++)
+		{
+			unsigned value = randomEngine.nextBelow(model.getValuesCount());
+			if (value != currentValue)
+				addValueCandidate(value, model.getConflictsCount(var, value), minConflicts, candidatesCount);
+		}
+
+		if (candidatesCount == 0 || (isInitialized && minConflicts > model.getCurrentConflictsCount(var)))
+			return NOT_FOUND;
+
+		return valueCandidates[getRandomIndexFromBehind(valueCandidates.size(), candidatesCount)];
+	}
+
+	unsigned getMinConflictsValue(unsigned var)
+	{
+		// With one value there is nothing to choose, and the scan below would find no value besides the current one
+		if (model.getValuesCount() <= 1)
+			return 0;
+
+		if (options.sampleSize && options.sampleSize + 1 < model.getValuesCount())
+		{
+			unsigned value = getSampledMinConflictsValue(var);
+			if (value != NOT_FOUND)
+				return value;
+		}
+
+		unsigned minConflicts = INT_MAX;
+		size_t candidatesCount = 0;
+		valueCandidates.clear();
+
+		unsigned currentValue = isInitialized ? model.getValue(var) : NOT_FOUND;
+		for (unsigned value = 0; value < model.getValuesCount(); value++)
+		{
+			if (value != currentValue)
+				addValueCandidate(value, model.getConflictsCount(var, value), minConflicts, candidatesCount);
+		}
+
+		return valueCandidates[getRandomIndexFromBehind(valueCandidates.size(), candidatesCount)];
+	}
+
+	void initialize()
+	{
+		if (!options.fastInit || !model.initializeFast(randomEngine, conflicts))
+		{
+			model.beginGreedyInitialization();
+			for (size_t var = 0; var < model.getVariablesCount(); var++)
+				model.assign(var, getMinConflictsValue(var), conflicts);
+			model.endGreedyInitialization();
+		}
+
+		isInitialized = true;
+	}
+
+	// Unassigns everything, so the next initialization starts over with new random choices
+	void clear()
+	{
+		model.clear();
+		conflicts.clear();
+		std::fill(tabuVars.begin(), tabuVars.end(), (unsigned)NOT_FOUND);
+		isInitialized = false;
+	}
+
+	bool isTabu(unsigned var)
+	{
+		return std::find(tabuVars.begin(), tabuVars.end(), var) != tabuVars.end();
+	}
+
+	// Draws again while the variable was moved recently, unless that is all the draws turn up
+	unsigned getNonTabuConflictedVar()
+	{
+		unsigned var = conflicts.getRandomConflicted(randomEngine);
+		for (unsigned attempt = 1; attempt < TABU_ATTEMPTS && isTabu(var); attempt++)
+		{
+			stats.tabuSkips++;
+			var = conflicts.getRandomConflicted(randomEngine);
+		}
+
+		return var;
+	}
+
+	// Moves a random conflicted variable rather than the most conflicted one, which would take a scan to find
+	void resolveConflicts()
+	{
+		unsigned var = tabuVars.empty() ? conflicts.getRandomConflicted(randomEngine) : getNonTabuConflictedVar();
+		unsigned value;
+		if (options.randomWalkProbability > 0 && randomEngine.nextDouble() < options.randomWalkProbability)
+		{
+			// Any value but the current one
+			value = randomEngine.nextBelow(model.getValuesCount() - 1);
+			if (value >= model.getValue(var))
+				value++;
+			stats.randomWalks++;
+		}
+		else
+			value = getMinConflictsValue(var);
+
+		if (model.getConflictsCount(var, value) >= model.getCurrentConflictsCount(var))
+			stats.sidewaysMoves++;
+
+		model.unassign(var, conflicts);
+		model.assign(var, value, conflicts);
+
+		if (!tabuVars.empty())
+		{
+			tabuVars[tabuNext] = var;
+			tabuNext = (tabuNext + 1) % tabuVars.size();
+		}
+	}
+
+public:
+	// The model comes in with every variable unassigned
+	MinConflictsEngine(Model&& model, const SolverOptions& options = SolverOptions())
+		: model(std::move(model)), options(options), conflicts(this->model.getVariablesCount()), randomEngine(options.seed),
+		tabuVars(options.tabuTenure, (unsigned)NOT_FOUND)
+	{
+		if (this->options.autoMaxSteps)
+			this->options.maxSteps = std::max<uint64_t>(AUTO_STEPS_PER_VARIABLE * this->model.getVariablesCount(), 1000);
+		if (this->model.getValuesCount() < 2)
+			this->options.randomWalkProbability = 0;
+	}
+
+	uint64_t getSeed() const
+	{
+		return options.seed;
+	}
+
+	const SolverStats& getStats() const
+	{
+		return stats;
+	}
+
+	Model& getModel()
+	{
+		return model;
+	}
+
+	// Whether the last failed solve() ran out of restarts, as opposed to the model having no solution
+	bool hasGivenUp() const
+	{
+		return isGivenUp;
+	}
+
+	// Returns false when there is no solution, the restarts ran out or a raised `cancelled` flag stopped the search
+	bool solve(const std::atomic<bool>* cancelled = nullptr)
+	{
+		isGivenUp = false;
+		if (model.isUnsolvable())
+			return false;
+
+		initialize();
+
+		// Walks that run too long are usually stuck on a plateau, and a new assignment is cheaper than waiting
+		uint64_t stepsSinceRestart = 0;
+		while (conflicts.hasConflicts())
+		{
+			if (cancelled && cancelled->load(std::memory_order_relaxed))
+				return false;
+
+			if (options.maxSteps && stepsSinceRestart == options.maxSteps)
+			{
+				if (stats.restarts == options.maxRestarts && options.maxRestarts)
+				{
+					isGivenUp = true;
+					return false;
+				}
+
+				clear();
+				initialize();
+				stats.restarts++;
+				stepsSinceRestart = 0;
+				continue;
+			}
+
+			resolveConflicts();
+			stats.steps++;
+			stepsSinceRestart++;
+		}
+
+		return true;
+	}
+};
@@ -1,246 +1,329 @@
 // Ivan Makaveev, 2MI0600203
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <utility>
 #include <vector>
-#include <random>
+#include <string>
 
-class NQueensSolver
+#include "GraphColoringModel.hpp"
+#include "MinConflictsEngine.hpp"
+#include "NQueensModel.hpp"
+
+enum class OutputMode
 {
-	bool isInitialized = false;
-	std::vector<unsigned> board;
-	std::vector<unsigned> rowQueens;
-	std::vector<unsigned> mainDiagQueens;
-	std::vector<unsigned> secDiagQueens;
+	Rows,  // the value of every variable (the row of every column's queen) on one line
+	Board,  // N lines of N cells for N-Queens, the same as Rows for other models
+	None
+};
 
-	unsigned getMainDiag(unsigned col, unsigned row)
-	{
-		return row - col + board.size() - 1;
-	}
+// Min-conflicts cannot prove that a graph needs more colors, so coloring gives up after this many restarts by default,
+// restarting after the automatic number of steps unless --max-steps says otherwise
+const uint64_t COLORING_MAX_RESTARTS = 100;
 
-	unsigned getSecDiag(unsigned col, unsigned row)
-	{
-		return row + col;
-	}
+struct OutputOptions
+{
+	OutputMode mode = OutputMode::Rows;
+	std::string binaryPath;  // also write the values to this file when set
+	bool verify = false;  // check the solution before printing it
+	bool stats = false;  // print the counters of the search as a "# STATS:" line
+};
 
-	void setConflictData(unsigned col, unsigned row, int stateChange)
-	{
-		rowQueens[row] += stateChange;
-		mainDiagQueens[getMainDiag(col, row)] += stateChange;
-		secDiagQueens[getSecDiag(col, row)] += stateChange;
-	}
+// The values of the variables. Numbers are formatted into a buffer that is written in large chunks,
+// since for big boards printing them one by one through the stream takes longer than the search.
+template <typename Model>
+void printValues(const Model& model, std::ostream& output)
+{
+	static const size_t BUFFER_SIZE = 1 << 16;
 
-	void addColQueen(unsigned col, unsigned row)
+	std::vector<char> buffer(BUFFER_SIZE + 16);  // room for the number that goes past BUFFER_SIZE
+	size_t used = 0;
+	for (size_t var = 0; var < model.getVariablesCount(); var++)
 	{
-		board[col] = row;
-		setConflictData(col, row, 1);
+		used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size() - 1, model.getValue(var)).ptr - buffer.data();
+		buffer[used++] = ' ';
+		if (used >= BUFFER_SIZE)
+		{
+			output.write(buffer.data(), used);
+			used = 0;
+		}
 	}
 
-	void removeColQueen(unsigned col)
-	{
-		setConflictData(col, board[col], -1);
-	}
+	buffer[used++] = '\n';
+	output.write(buffer.data(), used);
+}
 
-	unsigned getRandomIndexFromBehind(size_t collectionSize, size_t elementsCount)
-	{
-		return (collectionSize - 1) - std::rand() % elementsCount;
-	}
+template <typename Model>
+void printBoard(const Model& model, std::ostream& output)
+{
+	printValues(model, output);
+}
 
-	unsigned getConflictsCount(unsigned col, unsigned row)
-	{
-		return rowQueens[row] + mainDiagQueens[getMainDiag(col, row)] + secDiagQueens[getSecDiag(col, row)];
-	}
+template <typename LineWord>
+void printBoard(const NQueensModel<LineWord>& model, std::ostream& output)
+{
+	model.printBoard(output);
+}
 
-	unsigned getMinConflictsRow(unsigned col, bool skipCurrent = false)
-	{
-		unsigned minConflicts = INT_MAX;
+// The values as native-endian 32-bit integers, one per variable
+template <typename Model>
+bool writeBinary(const Model& model, const std::string& path)
+{
+	static const size_t BUFFER_SIZE = 1 << 14;
 
-		size_t candidatesCount = 0;
-		std::vector<unsigned> rowCandidates;
-		rowCandidates.reserve(board.size());
+	std::ofstream output(path, std::ios::binary);
+	if (!output)
+		return false;
 
-		for (size_t row = 0; row < board.size(); row++)
+	std::vector<uint32_t> buffer;
+	for (size_t var = 0; var < model.getVariablesCount(); var++)
+	{
+		buffer.push_back(model.getValue(var));
+		if (buffer.size() == BUFFER_SIZE || var + 1 == model.getVariablesCount())
 		{
-			if (row == board[col])
-			{
-				continue;
-			}
-
-			unsigned conflictsCount = getConflictsCount(col, row);
-			if (minConflicts >= conflictsCount)
-			{
-				if (minConflicts > conflictsCount)
-				{
-					candidatesCount = 0;
-					minConflicts = conflictsCount;
-				}
-
-				candidatesCount++;
-				rowCandidates.push_back(row);
-			}
+			output.write((const char*)buffer.data(), buffer.size() * sizeof(uint32_t));
+			buffer.clear();
 		}
+	}
 
-		//if (skipCurrent)
-		//{
-		//	// If the min-conflict column can only be moved at the current position only - we take the 2nd most min-conflict
-		//	if (candidatesCount == 1 && rowCandidates[rowCandidates.size() - 1] == board[col])
-		//		return rowCandidates[rowCandidates.size() - 2];
+	return (bool)output;
+}
 
-		//	unsigned result;
-		//	do
-		//	{
-		//		result = rowCandidates[getRandomIndexFromBehind(rowCandidates.size(), candidatesCount)];
-		//	} while (skipCurrent && result == board[col]);
+// -1 alone cannot tell a problem with no solution from a search that stopped looking, so a comment line says which
+void printNoSolution(bool hasGivenUp)
+{
+	std::cout << "# RESULT: " << (hasGivenUp ? "gave up, the restarts ran out" : "unsolvable") << std::endl;
+	std::cout << -1 << std::endl;
+}
 
-		//	return result;
-		//}
+template <typename Model>
+void printResult(MinConflictsEngine<Model>& engine, bool hasSolution, const OutputOptions& output)
+{
+	if (output.stats)
+		engine.getStats().print(std::cout);
 
-		return rowCandidates[getRandomIndexFromBehind(rowCandidates.size(), candidatesCount)];
+	if (!hasSolution)
+	{
+		printNoSolution(engine.hasGivenUp());
+		return;
 	}
 
-	void initializeBoard()
-	{
-		for (size_t col = 0; col < board.size(); col++)
-		{
-			unsigned row = getMinConflictsRow(col);
-			addColQueen(col, row);
-		}
+	Model& model = engine.getModel();
+	if (!output.binaryPath.empty() && !writeBinary(model, output.binaryPath))
+		std::cerr << "Cannot write " << output.binaryPath << std::endl;
+
+	if (output.verify)
+		std::cout << "# VERIFIED: " << (model.verify() ? "yes" : "no") << std::endl;
 
-		isInitialized = true;
+	if (output.mode == OutputMode::Rows)
+		printValues(model, std::cout);
+	else if (output.mode == OutputMode::Board)
+		printBoard(model, std::cout);
+	std::cout.flush();
+}
+
+/*
+	Runs independent min-conflicts walks with consecutive seeds, one per thread. The first walk to reach zero conflicts
+	stops the others, so a run takes as long as the luckiest seed instead of a typical one. Every walk has its own
+	copy of the model, so memory grows with the number of threads.
+*/
+template <typename Model>
+void printPortfolioSolve(Model&& model, size_t threadsCount, const SolverOptions& options, const OutputOptions& output)
+{
+	std::vector<std::unique_ptr<MinConflictsEngine<Model>>> engines;
+	for (size_t i = 0; i < threadsCount; i++)
+	{
+		SolverOptions walkOptions = options;
+		walkOptions.seed += i;
+		engines.emplace_back(new MinConflictsEngine<Model>(i + 1 < threadsCount ? Model(model) : std::move(model), walkOptions));
 	}
 
-	bool hasConflicts()
+	std::atomic<bool> isSolved{ false };
+	size_t winner = threadsCount;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < threadsCount; i++)
 	{
-		for (size_t col = 0; col < board.size(); col++)
+		threads.emplace_back([&engines, &isSolved, &winner, i]
 		{
-			if (getConflictsCount(col, board[col]) != 3)
-				return true;
-		}
-
-		return false;
+			if (engines[i]->solve(&isSolved) && !isSolved.exchange(true))
+				winner = i;
+		});
 	}
 
-	unsigned getMaxConflictsCol()
-	{
-		unsigned maxConflicts = 0;
+	for (std::thread& thread : threads)
+		thread.join();
+	auto end = std::chrono::high_resolution_clock::now();
 
-		size_t candidatesCount = 0;
-		std::vector<unsigned> colCandidates;
-		colCandidates.reserve(board.size());
+	std::chrono::duration<double, std::milli> duration = end - start;
+	std::cout << "# TIMES_MS: alg=" << duration.count() << std::endl;
 
-		for (size_t col = 0; col < board.size(); col++)
+	if (winner == threadsCount)
+	{
+		// Every walk ran out of restarts (or the problem has no solution), so the counters are those of all of them
+		if (output.stats)
 		{
-			unsigned conflictsCount = getConflictsCount(col, board[col]);
-			if (maxConflicts <= conflictsCount)
-			{
-				if (maxConflicts < conflictsCount)
-				{
-					candidatesCount = 0;
-					maxConflicts = conflictsCount;
-				}
-
-				candidatesCount++;
-				colCandidates.push_back(col);
-			}
+			SolverStats stats;
+			for (const auto& engine : engines)
+				stats.add(engine->getStats());
+			stats.print(std::cout);
 		}
 
-		return colCandidates[getRandomIndexFromBehind(colCandidates.size(), candidatesCount)];
+		printNoSolution(engines[0]->hasGivenUp());
+		return;
 	}
 
-	void resolveConflicts()
-	{
-		unsigned targetCol = getMaxConflictsCol();
-		unsigned targetRow = getMinConflictsRow(targetCol, true);
-
-		removeColQueen(targetCol);
-		addColQueen(targetCol, targetRow);
-	}
+	std::cout << "# SEED: " << engines[winner]->getSeed() << std::endl;
+	printResult(*engines[winner], true, output);
+}
 
-	bool solve()
+template <typename Model>
+void printSolve(Model&& model, size_t threadsCount, const SolverOptions& options, const OutputOptions& output)
+{
+	if (threadsCount > 1)
 	{
-		if (board.size() <= 1)
-			return true;
+		printPortfolioSolve(std::move(model), threadsCount, options, output);
+		return;
+	}
 
-		if (board.size() <= 3)
-			return false;
+	MinConflictsEngine<Model> engine(std::move(model), options);
 
-		initializeBoard();
+	auto start = std::chrono::high_resolution_clock::now();
+	bool hasSolution = engine.solve();
+	auto end = std::chrono::high_resolution_clock::now();
 
-		while (hasConflicts())
-		{
-			resolveConflicts();
-		}
+	std::chrono::duration<double, std::milli> duration = end - start;
+	std::cout << "# TIMES_MS: alg=" << duration.count() << std::endl;
 
-		return true;
-	}
+	printResult(engine, hasSolution, output);
+}
 
-	void printSolution(bool printFullBoard)
+/*
+	Command line:
+		--problem <name>        queens (default) - N-Queens with N read from the input,
+		                        coloring - graph coloring of "vertices edges colors" and the 0-based edges from the input;
+		                        a self-loop, an edge with 1 color or an odd cycle with 2 colors prints
+		                        "# RESULT: unsolvable" and -1 right away
+		--init <name>           fast (default) - the model's own placement (for N-Queens greedy on a random row
+		                        permutation in O(N)), min-conflicts - every variable on its least conflicted value
+		--sample <values>       values examined for every move, falling back to all values when none of them is
+		                        an improvement (default 100, 0 - always all values)
+		--threads <count>       independent walks with different seeds, the first one to finish is printed along with
+		                        its seed (default 1 - a single walk, 0 - all hardware threads)
+		--seed <number>         seed of the random choices, walks of a portfolio take the ones after it (default 0)
+		--max-steps <count>     moves before the walk starts over from a new assignment, or auto - 20 per variable,
+		                        at least 1000 (default 0 - never for N-Queens, auto for coloring)
+		--max-restarts <count>  restarts before giving up with "# RESULT: gave up, the restarts ran out" and -1
+		                        (default 100 for coloring, 0 - no limit for N-Queens, which always has a solution
+		                        for N other than 2 and 3)
+		--tabu <count>          how many of the last moved variables are not picked again (default 0)
+		--random-walk <p>       probability of moving the picked variable to a random value instead of the best one
+		                        (default 0)
+		--output <mode>         rows (default) - the value of every variable, board - N lines of "* " and "_ " for N-Queens,
+		                        none - only the comment lines
+		--binary <file>         also write the values to the file as native-endian 32-bit integers
+		--verify <on|off>       check the solution from the values alone and print "# VERIFIED: yes|no" (default off)
+		--stats <on|off>        print the counters of the search (of the printed walk in a portfolio, of all walks
+		                        when none finished) as "# STATS:" key=value pairs (default off)
+*/
+int main(int argc, char** argv)
+{
+	std::string problem = "queens";
+	SolverOptions options;
+	size_t threadsCount = 1;
+	OutputOptions output;
+	bool hasMaxSteps = false;
+	bool hasMaxRestarts = false;
+	for (int i = 1; i + 1 < argc; i++)
 	{
-		if (printFullBoard)
+		std::string arg = argv[i];
+		if (arg == "--problem")
 		{
-			for (int row = 0; row < board.size(); row++)
+			problem = argv[++i];
+			if (problem != "queens" && problem != "coloring")
 			{
-				for (int col = 0; col < board.size(); col++)
-				{
-					if (board[col] == row)
-						std::cout << "* ";
-					else
-						std::cout << "_ ";
-				}
-				std::cout << std::endl;
+				std::cerr << "Unknown problem " << problem << " (queens or coloring)" << std::endl;
+				return 1;
 			}
 		}
-		else
+		else if (arg == "--init")
+			options.fastInit = std::string(argv[++i]) != "min-conflicts";
+		else if (arg == "--sample")
+			options.sampleSize = std::stoul(argv[++i]);
+		else if (arg == "--threads")
+			threadsCount = std::stoul(argv[++i]);
+		else if (arg == "--seed")
+			options.seed = std::stoull(argv[++i]);
+		else if (arg == "--max-steps")
 		{
-			for (const auto& queen : board)
-				std::cout << queen << ' ';
+			std::string steps = argv[++i];
+			options.autoMaxSteps = steps == "auto";
+			options.maxSteps = options.autoMaxSteps ? 0 : std::stoull(steps);
+			hasMaxSteps = true;
 		}
-	}
-
-public:
-	NQueensSolver(size_t boardSize)
-		: board(boardSize, 0), rowQueens(boardSize, 0), mainDiagQueens(2 * boardSize - 1, 0), secDiagQueens(2 * boardSize - 1, 0)
-	{ }
-
-	void printSolve(bool printResult = true, bool fullSolution = false)
-	{
-		if (isInitialized)
+		else if (arg == "--max-restarts")
 		{
-			return;
+			options.maxRestarts = std::stoull(argv[++i]);
+			hasMaxRestarts = true;
 		}
-
-		auto start = std::chrono::high_resolution_clock::now();
-		bool hasSolution = solve();
-		auto end = std::chrono::high_resolution_clock::now();
-
-		std::chrono::duration<double, std::milli> duration = end - start;
-		std::cout << "# TIMES_MS: alg=" << duration.count() << std::endl;
-
-		if (!printResult)
+		else if (arg == "--tabu")
+			options.tabuTenure = std::stoul(argv[++i]);
+		else if (arg == "--random-walk")
+			options.randomWalkProbability = std::stod(argv[++i]);
+		else if (arg == "--output")
 		{
-			return;
+			std::string mode = argv[++i];
+			if (mode != "rows" && mode != "board" && mode != "none")
+			{
+				std::cerr << "Unknown output mode " << mode << " (rows, board or none)" << std::endl;
+				return 1;
+			}
+			output.mode = mode == "board" ? OutputMode::Board : mode == "none" ? OutputMode::None : OutputMode::Rows;
 		}
+		else if (arg == "--binary")
+			output.binaryPath = argv[++i];
+		else if (arg == "--verify")
+			output.verify = std::string(argv[++i]) == "on";
+		else if (arg == "--stats")
+			output.stats = std::string(argv[++i]) == "on";
+	}
 
-		if (!hasSolution)
-		{
-			std::cout << -1 << std::endl;
-		}
-		else
+	if (threadsCount == 0)
+		threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	if (problem == "coloring")
+	{
+		size_t verticesCount;
+		std::vector<std::pair<unsigned, unsigned>> edges;
+		unsigned colorsCount;
+		if (!GraphColoringModel::read(std::cin, verticesCount, edges, colorsCount))
 		{
-			printSolution(fullSolution);
+			std::cerr << "Invalid graph" << std::endl;
+			return 1;
 		}
-	}
 
-	void reset()
-	{
-		this->operator=(NQueensSolver(board.size()));
+		if (!hasMaxSteps)
+			options.autoMaxSteps = true;
+		if (!hasMaxRestarts)
+			options.maxRestarts = COLORING_MAX_RESTARTS;
+
+		printSolve(GraphColoringModel(verticesCount, edges, colorsCount), threadsCount, options, output);
+		return 0;
 	}
-};
 
-int main()
-{
 	size_t n;
 	std::cin >> n;
 
-	NQueensSolver solver(n);
-	solver.printSolve();
+	// Boards too big for 27-bit columns take 8 bytes per line
+	if (n <= NQueensModel<uint32_t>::MAX_SIZE)
+		printSolve(NQueensModel<uint32_t>(n), threadsCount, options, output);
+	else
+		printSolve(NQueensModel<uint64_t>(n), threadsCount, options, output);
 }
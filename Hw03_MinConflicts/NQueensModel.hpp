@@ -0,0 +1,294 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ConflictTracker.hpp"
+#include "RandomEngine.hpp"
+
+/*
+	N-Queens for MinConflictsEngine: every column is a variable and the row of its queen is the value.
+	Every row and diagonal of the board is one LineWord: the number of its queens in the top COUNT_BITS bits and the XOR
+	of their columns, which is the column of the queen when there is just one, in the rest. A 32-bit word holds columns
+	of boards up to 2^27, so a line takes 4 bytes and the whole solver about 24 bytes per queen.
+	Lines with more queens than the count bits can hold keep their real count in a hash map; min-conflicts hardly
+	ever gets there, so the map stays empty and costs one comparison per access.
+*/
+template <typename LineWord>
+class NQueensModel
+{
+	static const unsigned NOT_ASSIGNED = UINT_MAX;
+	static const unsigned COUNT_BITS = 5;
+	static const unsigned COL_BITS = sizeof(LineWord) * CHAR_BIT - COUNT_BITS;
+	static const LineWord COLS_MASK = ((LineWord)1 << COL_BITS) - 1;
+	static const unsigned OVERFLOW_COUNT = (1u << COUNT_BITS) - 1;
+
+	std::vector<unsigned> board;
+
+	// The rows, then the main diagonals, then the secondary ones, in one block
+	std::vector<LineWord> lines;
+	std::unordered_map<size_t, unsigned> overflowCounts;  // lines with at least OVERFLOW_COUNT queens
+
+	// Rows without a queen; the best rows for a move are almost always among them but too few for random sampling to find.
+	// Rows that got a queen since they were added are dropped only when they are sampled.
+	std::vector<unsigned> emptyRows;
+
+	size_t getRowLine(unsigned row) const
+	{
+		return row;
+	}
+
+	size_t getMainDiagLine(unsigned col, unsigned row) const
+	{
+		return 2 * board.size() - 1 + row - col;
+	}
+
+	size_t getSecDiagLine(unsigned col, unsigned row) const
+	{
+		return 3 * board.size() - 1 + row + col;
+	}
+
+	unsigned getQueensCount(size_t line)
+	{
+		unsigned count = (unsigned)(lines[line] >> COL_BITS);
+		return count == OVERFLOW_COUNT ? overflowCounts[line] : count;
+	}
+
+	unsigned getLineCol(size_t line)
+	{
+		return (unsigned)(lines[line] & COLS_MASK);
+	}
+
+	void setLine(size_t line, unsigned queensCount, unsigned colsXor)
+	{
+		if (queensCount >= OVERFLOW_COUNT)
+		{
+			overflowCounts[line] = queensCount;
+			queensCount = OVERFLOW_COUNT;
+		}
+		else if ((lines[line] >> COL_BITS) == OVERFLOW_COUNT)
+			overflowCounts.erase(line);
+
+		lines[line] = (LineWord)queensCount << COL_BITS | colsXor;
+	}
+
+	// Queens on the lines through a cell, counting the one standing on it
+	unsigned getLinesCount(unsigned col, unsigned row)
+	{
+		return getQueensCount(getRowLine(row)) + getQueensCount(getMainDiagLine(col, row))
+			+ getQueensCount(getSecDiagLine(col, row));
+	}
+
+	// A queen joining a lone one puts it under attack, and a queen leaving one other may free it.
+	// Two queens share at most one line, so the other lines of that queen are already up to date.
+	void updateLine(size_t line, unsigned col, int stateChange, ConflictTracker& conflicts)
+	{
+		unsigned queensCount = getQueensCount(line);
+		unsigned colsXor = getLineCol(line);
+		if (stateChange > 0)
+		{
+			conflicts.addConflicts(queensCount);
+			if (queensCount == 1)
+				conflicts.mark(colsXor);
+			queensCount++;
+		}
+		else
+		{
+			queensCount--;
+			conflicts.removeConflicts(queensCount);
+		}
+
+		colsXor ^= col;
+		setLine(line, queensCount, colsXor);
+		if (stateChange < 0 && queensCount == 1 && getLinesCount(colsXor, board[colsXor]) == 3)
+			conflicts.unmark(colsXor);
+	}
+
+	void setConflictData(unsigned col, unsigned row, int stateChange, ConflictTracker& conflicts)
+	{
+		updateLine(getRowLine(row), col, stateChange, conflicts);
+		updateLine(getMainDiagLine(col, row), col, stateChange, conflicts);
+		updateLine(getSecDiagLine(col, row), col, stateChange, conflicts);
+
+		if (stateChange < 0 && getQueensCount(getRowLine(row)) == 0)
+			emptyRows.push_back(row);
+	}
+
+public:
+	static const size_t MAX_SIZE = std::min<size_t>((size_t)COLS_MASK + 1, UINT_MAX);
+
+	explicit NQueensModel(size_t boardSize)
+		: board(boardSize, (unsigned)NOT_ASSIGNED), lines(boardSize ? 5 * boardSize - 2 : 0)
+	{ }
+
+	size_t getVariablesCount() const
+	{
+		return board.size();
+	}
+
+	unsigned getValuesCount() const
+	{
+		return (unsigned)board.size();
+	}
+
+	unsigned getValue(unsigned col) const
+	{
+		return board[col];
+	}
+
+	unsigned getConflictsCount(unsigned col, unsigned row)
+	{
+		return getLinesCount(col, row);
+	}
+
+	// The current row counts the queen itself on all three of its lines
+	unsigned getCurrentConflictsCount(unsigned col)
+	{
+		return getLinesCount(col, board[col]) - 3;
+	}
+
+	void assign(unsigned col, unsigned row, ConflictTracker& conflicts)
+	{
+		board[col] = row;
+		setConflictData(col, row, 1, conflicts);
+		if (getLinesCount(col, row) != 3)
+			conflicts.mark(col);
+	}
+
+	void unassign(unsigned col, ConflictTracker& conflicts)
+	{
+		setConflictData(col, board[col], -1, conflicts);
+		board[col] = NOT_ASSIGNED;
+		conflicts.unmark(col);
+	}
+
+	void clear()
+	{
+		std::fill(board.begin(), board.end(), (unsigned)NOT_ASSIGNED);
+		std::fill(lines.begin(), lines.end(), 0);
+		overflowCounts.clear();
+		emptyRows.clear();
+	}
+
+	bool isUnsolvable() const
+	{
+		return board.size() == 2 || board.size() == 3;
+	}
+
+	// Places the queens on a random permutation of the rows, so no two share a row. Every column draws up to
+	// FAST_INIT_ATTEMPTS of the rows still free and takes the first one with both diagonals empty (or the last one drawn).
+	// Free diagonals only run out near the end, so the board starts with few conflicts in O(N) time.
+	// The free rows are kept in the part of `board` not yet taken by queens, so they need no memory of their own.
+	bool initializeFast(RandomEngine& randomEngine, ConflictTracker& conflicts)
+	{
+		static const unsigned FAST_INIT_ATTEMPTS = 32;
+
+		for (size_t row = 0; row < board.size(); row++)
+			board[row] = row;
+
+		for (size_t col = 0; col < board.size(); col++)
+		{
+			size_t index;
+			for (unsigned attempt = 0; attempt < FAST_INIT_ATTEMPTS; attempt++)
+			{
+				index = col + randomEngine.nextBelow((uint32_t)(board.size() - col));
+				unsigned row = board[index];
+				if (getQueensCount(getMainDiagLine(col, row)) == 0 && getQueensCount(getSecDiagLine(col, row)) == 0)
+					break;
+			}
+
+			unsigned row = board[index];
+			board[index] = board[col];
+			assign(col, row, conflicts);
+		}
+
+		return true;
+	}
+
+	void beginGreedyInitialization()
+	{
+		emptyRows.resize(board.size());
+		for (size_t row = 0; row < emptyRows.size(); row++)
+			emptyRows[row] = row;
+	}
+
+	// Only the rows left empty are kept
+	void endGreedyInitialization()
+	{
+		emptyRows.erase(std::remove_if(emptyRows.begin(), emptyRows.end(),
+			[this](unsigned row) { return getQueensCount(getRowLine(row)) != 0; }), emptyRows.end());
+		emptyRows.shrink_to_fit();
+	}
+
+	// Random empty rows, or all of them when there are no more than `limit`
+	template <typename Visitor>
+	void forEachPromisingValue(unsigned, size_t limit, RandomEngine& randomEngine, Visitor visit)
+	{
+		size_t examined = 0;
+		while (examined < limit && examined < emptyRows.size())
+		{
+			size_t index = emptyRows.size() <= limit ? examined : randomEngine.nextBelow((uint32_t)emptyRows.size());
+			unsigned row = emptyRows[index];
+			if (getQueensCount(getRowLine(row)) != 0)
+			{
+				emptyRows[index] = emptyRows.back();
+				emptyRows.pop_back();
+				continue;
+			}
+
+			visit(row);
+			examined++;
+		}
+	}
+
+	// Recounts the queens on every line from the board alone, so the solution is checked without trusting the counters
+	// kept during the search. Their memory is reused, so the search cannot go on afterwards.
+	bool verify()
+	{
+		std::fill(lines.begin(), lines.end(), 0);
+		overflowCounts.clear();
+
+		for (size_t col = 0; col < board.size(); col++)
+		{
+			unsigned row = board[col];
+			if (row >= board.size())
+				return false;
+
+			for (size_t line : { getRowLine(row), getMainDiagLine(col, row), getSecDiagLine(col, row) })
+			{
+				if (lines[line] != 0)
+					return false;
+				lines[line] = 1;
+			}
+		}
+
+		return true;
+	}
+
+	// The whole board, a line of "* " and "_ " per row; one row buffer is reused with just its queen changed
+	void printBoard(std::ostream& output) const
+	{
+		std::vector<unsigned> rowQueens(board.size());  // column of the queen on every row
+		for (size_t col = 0; col < board.size(); col++)
+			rowQueens[board[col]] = col;
+
+		std::string line(2 * board.size() + 1, '_');
+		for (size_t i = 1; i < line.size(); i += 2)
+			line[i] = ' ';
+		line.back() = '\n';
+
+		for (unsigned col : rowQueens)
+		{
+			line[2 * col] = '*';
+			output.write(line.data(), line.size());
+			line[2 * col] = '_';
+		}
+	}
+};
@@ -0,0 +1,68 @@
+// Ivan Makaveev, 2MI0600203
+
+#pragma once
+#include <cstdint>
+
+/*
+	xoshiro256** seeded through splitmix64, so every 64-bit seed gives a well mixed state. It is a few shifts and
+	rotations per number, several times faster than std::mt19937 and with a 32-byte state instead of 2.5 KB.
+	nextBelow maps the top 32 bits onto [0, bound) by multiplying instead of dividing (Lemire's method) and redraws
+	the few values that would make the lower results more likely, so every index is equally likely.
+*/
+class RandomEngine
+{
+	uint64_t state[4];
+
+	static uint64_t rotateLeft(uint64_t value, int shift)
+	{
+		return (value << shift) | (value >> (64 - shift));
+	}
+
+public:
+	explicit RandomEngine(uint64_t seed)
+	{
+		for (uint64_t& word : state)
+		{
+			seed += 0x9E3779B97F4A7C15ull;
+			uint64_t mixed = seed;
+			mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+			mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+			word = mixed ^ (mixed >> 31);
+		}
+	}
+
+	uint64_t next()
+	{
+		uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+		uint64_t shifted = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= shifted;
+		state[3] = rotateLeft(state[3], 45);
+
+		return result;
+	}
+
+	// A uniform number in [0, 1)
+	double nextDouble()
+	{
+		return (next() >> 11) * 0x1.0p-53;
+	}
+
+	// A uniform number in [0, bound), bound > 0
+	uint32_t nextBelow(uint32_t bound)
+	{
+		uint64_t product = (next() >> 32) * bound;
+		if ((uint32_t)product < bound)
+		{
+			uint32_t threshold = (0u - bound) % bound;
+			while ((uint32_t)product < threshold)
+				product = (next() >> 32) * bound;
+		}
+
+		return (uint32_t)(product >> 32);
+	}
+};